@@ -0,0 +1,87 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "arena.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+namespace sid = foonathan::string_id;
+
+FOONATHAN_CONSTEXPR std::size_t sid::detail::memory_arena::default_slab_size;
+
+/// \cond impl
+struct sid::detail::memory_arena::slab
+{
+    slab *next;
+    std::size_t size; // including this header
+
+    char* memory() FOONATHAN_NOEXCEPT
+    {
+        void* mem = this;
+        return static_cast<char*>(mem) + sizeof(slab);
+    }
+};
+/// \endcond
+
+void* sid::detail::memory_arena::allocate(std::size_t size, std::size_t alignment)
+{
+    assert(alignment != 0u && (alignment & (alignment - 1)) == 0u && alignment <= alignof(slab));
+    auto misaligned = reinterpret_cast<std::uintptr_t>(cur_) & (alignment - 1);
+    auto padding = misaligned ? alignment - misaligned : 0u;
+    if (cur_ && padding + size <= static_cast<std::size_t>(end_ - cur_))
+    {
+        auto mem = cur_ + padding;
+        cur_ = mem + size;
+        used_ += padding + size;
+        return mem;
+    }
+    else if (size > slab_size_ / 4)
+    {
+        // big allocations get their own slab, so the current one can still be used
+        auto s = allocate_slab(size);
+        if (head_)
+        {
+            s->next = head_->next;
+            head_->next = s;
+        }
+        else
+        {
+            s->next = nullptr;
+            head_ = s;
+        }
+        used_ += size;
+        return s->memory();
+    }
+
+    auto s = allocate_slab(slab_size_);
+    s->next = head_;
+    head_ = s;
+    cur_ = s->memory() + size;
+    end_ = s->memory() + slab_size_;
+    used_ += size;
+    return s->memory();
+}
+
+void sid::detail::memory_arena::release() FOONATHAN_NOEXCEPT
+{
+    while (head_)
+    {
+        auto next = head_->next;
+        ::operator delete(head_);
+        head_ = next;
+    }
+    cur_ = end_ = nullptr;
+    reserved_ = used_ = 0u;
+}
+
+sid::detail::memory_arena::slab* sid::detail::memory_arena::allocate_slab(std::size_t size)
+{
+    auto mem = ::operator new(sizeof(slab) + size);
+    auto s = ::new(mem) slab;
+    s->size = sizeof(slab) + size;
+    reserved_ += s->size;
+    return s;
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_ARENA_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_ARENA_HPP_INCLUDED
+
+#include <cstddef>
+
+#include "config.hpp"
+
+namespace foonathan { namespace string_id
+{
+    namespace detail
+    {
+        // allocates memory from big slabs by bumping a pointer
+        // memory can't be freed individually, only all at once
+        class memory_arena
+        {
+        public:
+            static FOONATHAN_CONSTEXPR std::size_t default_slab_size = 64 * 1024u;
+
+            explicit memory_arena(std::size_t slab_size = default_slab_size) FOONATHAN_NOEXCEPT
+            : head_(nullptr), cur_(nullptr), end_(nullptr),
+              slab_size_(slab_size), reserved_(0u), used_(0u) {}
+
+            memory_arena(const memory_arena &) = delete;
+            memory_arena& operator=(const memory_arena &) = delete;
+
+            ~memory_arena() FOONATHAN_NOEXCEPT
+            {
+                release();
+            }
+
+            // alignment must be a power of two
+            void* allocate(std::size_t size, std::size_t alignment);
+
+            // frees all slabs
+            void release() FOONATHAN_NOEXCEPT;
+
+            // total size of all slabs
+            std::size_t bytes_reserved() const FOONATHAN_NOEXCEPT
+            {
+                return reserved_;
+            }
+
+            // total size of all allocations, including alignment padding
+            std::size_t bytes_used() const FOONATHAN_NOEXCEPT
+            {
+                return used_;
+            }
+
+        private:
+            struct slab;
+
+            slab* allocate_slab(std::size_t size);
+
+            slab *head_;
+            char *cur_, *end_;
+            std::size_t slab_size_, reserved_, used_;
+        };
+    } // namespace detail
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_ARENA_HPP_INCLUDED
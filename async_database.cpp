@@ -0,0 +1,261 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "async_database.hpp"
+
+#include <cstring>
+#include <new>
+
+#include "string_id.hpp"
+
+namespace sid = foonathan::string_id;
+
+/// \cond impl
+struct sid::async_database::node
+{
+    node *next;
+    hash_type hash;
+    std::size_t length;
+
+    // the string is stored after the node
+    static node* create(hash_type hash, const char *prefix, std::size_t length_prefix,
+                        const char *str, std::size_t length_string)
+    {
+        auto mem = ::operator new(sizeof(node) + length_prefix + length_string + 1);
+        auto n = ::new(mem) node{nullptr, hash, length_prefix + length_string};
+        auto dest = const_cast<char*>(n->get_str());
+        std::memcpy(dest, prefix, length_prefix);
+        std::memcpy(dest + length_prefix, str, length_string);
+        dest[n->length] = 0;
+        return n;
+    }
+
+    static void destroy(node *n) FOONATHAN_NOEXCEPT
+    {
+        ::operator delete(n);
+    }
+
+    const char* get_str() const FOONATHAN_NOEXCEPT
+    {
+        const void *mem = this + 1;
+        return static_cast<const char*>(mem);
+    }
+};
+/// \endcond
+
+sid::async_database::async_database(basic_database &target)
+: target_(target), head_(nullptr), stop_(false),
+  thread_(&async_database::run, this) {}
+
+sid::async_database::~async_database() FOONATHAN_NOEXCEPT
+{
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+}
+
+sid::basic_database::insert_status sid::async_database::insert(hash_type hash, const char *str, std::size_t length)
+{
+    auto n = node::create(hash, "", 0u, str, length);
+    push(n, n);
+    return new_string;
+}
+
+sid::basic_database::insert_status sid::async_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                      const char *str, std::size_t length)
+{
+    auto prefix_str = async_database::lookup(prefix);
+    auto n = node::create(hash, prefix_str, std::strlen(prefix_str), str, length);
+    push(n, n);
+    return new_string;
+}
+
+void sid::async_database::insert_batch(const hash_type *hashes, const string_info *strings,
+                                       insert_status *status, std::size_t count)
+{
+    if (count == 0u)
+        return;
+    // the queue is in reverse order, so each node points to the one before
+    node *first = nullptr, *last = nullptr;
+    try
+    {
+        for (std::size_t i = 0u; i != count; ++i)
+        {
+            auto n = node::create(hashes[i], "", 0u, strings[i].string, strings[i].length);
+            n->next = first;
+            first = n;
+            if (!last)
+                last = n;
+            status[i] = new_string;
+        }
+    }
+    catch (...)
+    {
+        while (first)
+        {
+            auto next = first->next;
+            node::destroy(first);
+            first = next;
+        }
+        throw;
+    }
+    push(first, last);
+}
+
+const char* sid::async_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (auto str = target_.find(hash))
+        return str;
+    flush_pending();
+    return target_.lookup(hash);
+}
+
+const char* sid::async_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (auto str = target_.find(hash))
+        return str;
+    flush_pending();
+    return target_.find(hash);
+}
+
+bool sid::async_database::erase(hash_type hash)
+{
+    flush_pending();
+    if (!target_.erase(hash))
+        return false;
+    invalidate_caches();
+    return true;
+}
+
+sid::database_statistics sid::async_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    return target_.statistics();
+}
+
+void sid::async_database::flush()
+{
+    node *collisions = nullptr;
+    std::unique_lock<std::mutex> lock(drain_mutex_);
+    drain(collisions);
+    lock.unlock();
+    handle_collisions(collisions);
+
+    lock.lock();
+    if (exception_)
+    {
+        auto exception = exception_;
+        exception_ = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void sid::async_database::push(node *first, node *last) FOONATHAN_NOEXCEPT
+{
+    // last->next must not be read after the exchange, the node might already be drained
+    auto old_head = head_.load(std::memory_order_relaxed);
+    do
+        last->next = old_head;
+    while (!head_.compare_exchange_weak(old_head, first,
+                                        std::memory_order_release, std::memory_order_relaxed));
+    if (!old_head)
+    {
+        // the queue was empty, so the background thread might be waiting
+        // it checks the queue while holding wait_mutex_, so the notification can't get lost
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+        }
+        wakeup_.notify_one();
+    }
+}
+
+void sid::async_database::drain(node *&collisions) const FOONATHAN_NOEXCEPT
+{
+    auto list = head_.exchange(nullptr, std::memory_order_acquire);
+    if (!list)
+        return;
+
+    // reverse, so that the strings are inserted in order
+    node *cur = nullptr;
+    while (list)
+    {
+        auto next = list->next;
+        list->next = cur;
+        cur = list;
+        list = next;
+    }
+
+    // the collisions are in reverse order again, the handler doesn't care
+    while (cur)
+    {
+        auto next = cur->next;
+        auto is_collision = false;
+        try
+        {
+            is_collision = target_.insert(cur->hash, cur->get_str(), cur->length) == collision;
+        }
+        catch (...)
+        {
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+        if (is_collision)
+        {
+            cur->next = collisions;
+            collisions = cur;
+        }
+        else
+            node::destroy(cur);
+        cur = next;
+    }
+}
+
+void sid::async_database::handle_collisions(node *collisions) const FOONATHAN_NOEXCEPT
+{
+    while (collisions)
+    {
+        try
+        {
+            detail::handle_collision(target_, collisions->hash, collisions->get_str());
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+        auto next = collisions->next;
+        node::destroy(collisions);
+        collisions = next;
+    }
+}
+
+void sid::async_database::flush_pending() const FOONATHAN_NOEXCEPT
+{
+    node *collisions = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain(collisions);
+    }
+    handle_collisions(collisions);
+}
+
+void sid::async_database::run() FOONATHAN_NOEXCEPT
+{
+    for (auto stop = false; !stop;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wakeup_.wait(lock, [&]
+                               {
+                                   return stop_ || head_.load(std::memory_order_relaxed);
+                               });
+            stop = stop_;
+        }
+        // inserts the remaining strings after stopping as well
+        flush_pending();
+    }
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_ASYNC_DATABASE_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_ASYNC_DATABASE_HPP_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief A database adapter that inserts the strings into another database on a background thread.
+    /// \detail An insertion only copies the string into a lock-free queue,
+    /// a background thread inserts them into the target database and calls the \ref collision_handler.
+    /// Because of that, insertions always return \c new_string and a collision is only detected later.
+    /// If the handler throws, the exception is stored and rethrown by the next call to \ref flush().<br>
+    /// \c lookup() and \c find() consult the target database first,
+    /// if the string isn't stored there yet, all pending strings are inserted by the calling thread.<br>
+    /// The target database must stay valid as long as the adapter
+    /// and must be thread safe if it is used by other threads as well.
+    /// The adapter itself is thread safe.
+    class async_database : public basic_database
+    {
+    public:
+        /// \brief Creates the adapter and starts the background thread.
+        explicit async_database(basic_database &target);
+
+        /// \brief Inserts all pending strings and stops the background thread.
+        /// \detail Exceptions of the \ref collision_handler are ignored.
+        ~async_database() FOONATHAN_NOEXCEPT;
+
+        /// \brief Copies the string into the queue.
+        /// \return Always \c new_string.
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Copies the concatenation of prefix and string into the queue.
+        /// \detail The prefix is retrieved using \c lookup().
+        /// \return Always \c new_string.
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Copies all strings into the queue at once.
+        /// \detail All statuses are \c new_string.
+        void insert_batch(const hash_type *hashes, const string_info *strings,
+                          insert_status *status, std::size_t count) FOONATHAN_OVERRIDE;
+
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Inserts all pending strings and erases the string from the target database.
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the statistics of the target database.
+        /// \detail Pending strings are not included.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Inserts all strings inserted before the call into the target database.
+        /// \detail If the \ref collision_handler has thrown an exception since the last call,
+        /// it is rethrown after all strings are inserted.
+        /// The handler is called without holding a lock of this database, so it may use it as well.
+        /// If another thread is calling the handler at the same time,
+        /// an exception thrown by it is only rethrown by the next call.
+        void flush();
+
+        /// \brief Returns the target database.
+        basic_database& target() const FOONATHAN_NOEXCEPT
+        {
+            return target_;
+        }
+
+    private:
+        // the target can erase strings without invalidating the caches of the adapter
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return false;
+        }
+
+        struct node;
+
+        void push(node *first, node *last) FOONATHAN_NOEXCEPT;
+        // drain_mutex_ must be locked
+        // the nodes of the collisions are put into collisions instead of destroying them
+        void drain(node *&collisions) const FOONATHAN_NOEXCEPT;
+        // drain_mutex_ must not be locked, so that the handler can use this database
+        // destroys the nodes, stores the first exception
+        void handle_collisions(node *collisions) const FOONATHAN_NOEXCEPT;
+        // locks drain_mutex_ and drains, exceptions stay stored
+        void flush_pending() const FOONATHAN_NOEXCEPT;
+        void run() FOONATHAN_NOEXCEPT;
+
+        basic_database &target_;
+        // pending strings in reverse order
+        mutable std::atomic<node*> head_;
+        mutable std::mutex drain_mutex_;
+        // first exception thrown while inserting, protected by drain_mutex_
+        mutable std::exception_ptr exception_;
+        // only held while checking whether the background thread has to wait
+        std::mutex wait_mutex_;
+        std::condition_variable wakeup_;
+        bool stop_; // protected by wait_mutex_
+        std::thread thread_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_ASYNC_DATABASE_HPP_INCLUDED
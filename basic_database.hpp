@@ -5,11 +5,61 @@
 #ifndef FOONATHAN_STRING_ID_BASIC_DATABASE_HPP_INCLUDED
 #define FOONATHAN_STRING_ID_BASIC_DATABASE_HPP_INCLUDED
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
 #include "config.hpp"
 #include "hash.hpp"
 
 namespace foonathan { namespace string_id
 {
+    /// \brief Information about a string.
+    /// \detail It is used to reduce the number of constructors of \ref string_id.
+    struct string_info
+    {
+        /// \brief A pointer to a null-terminated string.
+        const char *string;
+        /// \brief The length of this string.
+        std::size_t length;
+        
+        /// \brief Creates it from a null-terminated string (implicit conversion).
+        string_info(const char *str) FOONATHAN_NOEXCEPT
+        : string(str), length(std::strlen(str)) {}
+        
+        /// \brief Creates it from a string with given length.
+        /// \arg \c str does not need to be null-terminated.
+        string_info(const char *str, std::size_t length)
+        : string(str), length(length) {}
+    };
+
+    /// \brief Statistics about the contents of a database.
+    /// \detail Values a database does not track are \c 0.
+    struct database_statistics
+    {
+        /// \brief The number of entries in the \ref chain_length histogram.
+        static FOONATHAN_CONSTEXPR std::size_t histogram_size = 8u;
+
+        /// \brief The number of strings stored.
+        std::size_t no_strings;
+        /// \brief The number of buckets or slots of the hash table.
+        std::size_t no_buckets;
+        /// \brief The number of buckets whose chain has a given length.
+        /// \detail The last entry counts all buckets with that length or more.
+        /// It is only tracked by databases using separate chaining.
+        std::size_t chain_length[histogram_size];
+        /// \brief The number of bytes used by the strings itself, including null-terminators.
+        std::size_t string_bytes;
+        /// \brief The number of all other bytes allocated by the database.
+        std::size_t overhead_bytes;
+        /// \brief The number of insertions that resulted in a collision.
+        std::size_t no_collisions;
+        /// \brief The number of times the hash table has been grown.
+        std::size_t no_rehashes;
+        /// \brief The total time spent growing the hash table in nanoseconds.
+        std::uint64_t rehash_nanoseconds;
+    };
+
 	/// \brief The interface for all databases.
     /// \detail You can derive own databases from it.
     class basic_database
@@ -56,15 +106,92 @@ namespace foonathan { namespace string_id
         virtual insert_status insert_prefix(hash_type hash, hash_type prefix,
                                             const char *str, std::size_t length);
         
+        /// \brief Inserts multiple hash-string-pairs into the internal database.
+        /// \detail The default implementation calls \ref insert for each of them.<br>
+        /// Override it if you can do it more efficiently.
+        /// \arg \c hashes is an array of the hashes of the strings.
+        /// \arg \c strings is an array of the strings itself.
+        /// \arg \c status is an array where the \ref insert_status of each string will be stored.
+        /// \arg \c count is the size of all three arrays.
+        virtual void insert_batch(const hash_type *hashes, const string_info *strings,
+                                  insert_status *status, std::size_t count);
+
+        /// \brief Inserts multiple hash-string-pairs with the same prefix into the internal database.
+        /// \detail The default implementation calls \ref insert_prefix for each of them.<br>
+        /// Override it if you can do it more efficiently.
+        /// \arg \c hashes is an array of the hashes of the strings plus prefix.
+        /// \arg \c prefix is the hash of the prefix-string.
+        /// \arg \c strings is an array of the suffixes.
+        /// \arg \c status is an array where the \ref insert_status of each string will be stored.
+        /// \arg \c count is the size of all three arrays.
+        virtual void insert_prefix_batch(const hash_type *hashes, hash_type prefix, const string_info *strings,
+                                         insert_status *status, std::size_t count);
+
+        /// \brief Inserts a hash-string-pair where the string is given as a sequence of segments.
+        /// \detail The default implementation concatenates all segments and calls \ref insert.<br>
+        /// Override it if you can do it without the temporary string.
+        /// \arg \c hash is the hash of the concatenation of all segments.
+        /// \arg \c segments is an array of the segments, they do not need to be null-terminated.
+        /// \arg \c count is the size of the array, it must not be \c 0.
+        /// \return The \ref insert_status.
+        virtual insert_status insert_segments(hash_type hash, const string_info *segments, std::size_t count);
+        
         /// \brief Should return the string stored with a given hash.
         /// \detail It is guaranteed that the hash value has been inserted before.
         /// \return A null-terminated string belonging to the hash code or
         /// an error message if the database does not store anything.<br>
         /// The return value must stay valid as long as the database exists.
         virtual const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT = 0;
+
+        /// \brief Removes the string stored with a given hash.
+        /// \detail Afterwards the hash is treated as if it has never been inserted,
+        /// strings returned by \ref lookup for it are not valid anymore.<br>
+        /// The default implementation does nothing and returns \c false, i.e. the database does not support it.
+        /// The complexity depends on the database, see e.g. \ref map_database::erase.
+        /// \return \c true if the string was removed, \c false if there was none or it can't be removed.
+        virtual bool erase(hash_type hash);
+
+        /// \brief Returns the string stored with a given hash or \c nullptr if there is none.
+        /// \detail Unlike \ref lookup the hash does not need to be inserted and it does not modify the database.<br>
+        /// The default implementation returns \c nullptr, i.e. the database can't tell.
+        virtual const char* find(hash_type hash) const FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns \ref database_statistics about the database.
+        /// \detail The default implementation returns all values \c 0.<br>
+        /// It should be cheap enough to be called periodically, e.g. by not iterating over all strings.
+        virtual database_statistics statistics() const FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns a number identifying the database and the strings it has stored.
+        /// \detail It is unique among all databases ever created by the program
+        /// and changes each time \ref invalidate_caches() is called.
+        /// It is \c 0 if \ref cacheable() returns \c false.<br>
+        /// The thread-local intern cache of \ref string_id uses it to check whether its entries are still valid,
+        /// see \ref FOONATHAN_STRING_ID_INTERN_CACHE.
+        std::uint64_t cache_id() const FOONATHAN_NOEXCEPT
+        {
+            return cacheable() ? cache_id_.load(std::memory_order_acquire) : 0u;
+        }
         
     protected:
-        basic_database() = default;
+        basic_database() FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns whether or not information about this database may be cached by other parts of the library.
+        /// \detail If it returns \c true, the thread-local intern cache of \ref string_id does not call \ref insert
+        /// for strings the thread has recently inserted, the database must call \ref invalidate_caches() then.<br>
+        /// The default implementation returns \c false, so databases that are not aware of it keep working unchanged.
+        virtual bool cacheable() const FOONATHAN_NOEXCEPT
+        {
+            return false;
+        }
+
+        /// \brief Invalidates all information about this database cached by other parts of the library.
+        /// \detail Databases that are \ref cacheable() must call it when a string stops being stored
+        /// or is replaced by another one.
+        /// It is not necessary to call it in the destructor.
+        void invalidate_caches() FOONATHAN_NOEXCEPT;
+
+    private:
+        std::atomic<std::uint64_t> cache_id_;
     };
 }} // foonathan::string_id
 
@@ -0,0 +1,147 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_BASIC_STRING_ID_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_BASIC_STRING_ID_HPP_INCLUDED
+
+#include <functional>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "hash.hpp"
+#include "string_id.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief A string identifier bound to a database chosen at compile-time.
+    /// \detail The database is returned by the function \c GetDatabase,
+    /// so the id only stores the hash and is as big as \ref hash_type.<br>
+    /// All calls to the database are qualified with \c Database,
+    /// so they are resolved at compile-time and can be inlined.
+    /// \c Database must be the most derived type of the object returned by \c GetDatabase.<br>
+    /// Apart from that, it behaves like \ref string_id.
+    template <class Database, Database& (*GetDatabase)()>
+    class basic_string_id
+    {
+    public:
+        /// \brief The type of the database.
+        typedef Database database_type;
+
+        //=== constructors ===//
+        /// \brief Creates a new id by hashing a given string.
+        /// \detail It will insert the string into the database which will copy it.<br>
+        /// If it encounters a collision, the \ref collision_handler will be called.
+        explicit basic_string_id(string_info str)
+        : id_(detail::sid_hash_n(str.string, str.length))
+        {
+            auto status = database().Database::insert(id_, str.string, str.length);
+            if (!status)
+                detail::handle_collision(database(), id_, str.string);
+        }
+
+        /// \brief Creates a new id with a given prefix.
+        /// \detail Otherwise the same as other constructor.
+        basic_string_id(const basic_string_id &prefix, string_info str)
+        : id_(detail::sid_hash_n(str.string, str.length, prefix.id_))
+        {
+            auto status = database().Database::insert_prefix(id_, prefix.id_, str.string, str.length);
+            if (!status)
+                detail::handle_collision(database(), id_, str.string);
+        }
+
+        /// @{
+        /// \brief Sames as other constructor versions but instead of calling the \ref collision_handler,
+        /// they set the output parameter to the appropriate status.
+        basic_string_id(string_info str, basic_database::insert_status &status)
+        : id_(detail::sid_hash_n(str.string, str.length))
+        {
+            status = database().Database::insert(id_, str.string, str.length);
+        }
+
+        basic_string_id(const basic_string_id &prefix, string_info str,
+                        basic_database::insert_status &status)
+        : id_(detail::sid_hash_n(str.string, str.length, prefix.id_))
+        {
+            status = database().Database::insert_prefix(id_, prefix.id_, str.string, str.length);
+        }
+        /// @}
+
+        //=== accessors ===//
+        /// \brief Returns the hashed value of the string.
+        hash_type hash_code() const FOONATHAN_NOEXCEPT
+        {
+            return id_;
+        }
+
+        /// \brief Returns a reference to the database.
+        static Database& database() FOONATHAN_NOEXCEPT
+        {
+            return GetDatabase();
+        }
+
+        /// \brief Returns the string value itself.
+        /// \detail This calls the \c lookup function on the database.
+        const char* string() const FOONATHAN_NOEXCEPT
+        {
+            return database().Database::lookup(id_);
+        }
+
+        //=== comparision ===//
+        /// @{
+        /// \brief Compares string ids with another or hashed values.
+        /// \detail Since all ids of this type belong to the same database,
+        /// they are equal if they have the same value.
+        friend bool operator==(basic_string_id a, basic_string_id b) FOONATHAN_NOEXCEPT
+        {
+            return a.id_ == b.id_;
+        }
+
+        friend bool operator==(hash_type a, basic_string_id b) FOONATHAN_NOEXCEPT
+        {
+            return a == b.id_;
+        }
+
+        friend bool operator==(basic_string_id a, hash_type b) FOONATHAN_NOEXCEPT
+        {
+            return a.id_ == b;
+        }
+
+        friend bool operator!=(basic_string_id a, basic_string_id b) FOONATHAN_NOEXCEPT
+        {
+            return !(a == b);
+        }
+
+        friend bool operator!=(hash_type a, basic_string_id b) FOONATHAN_NOEXCEPT
+        {
+            return !(a == b);
+        }
+
+        friend bool operator!=(basic_string_id a, hash_type b) FOONATHAN_NOEXCEPT
+        {
+            return !(a == b);
+        }
+        /// @}
+
+    private:
+        hash_type id_;
+    };
+}} // namespace foonathan::string_id
+
+namespace std
+{
+    /// \brief \c std::hash support for \ref basic_string_id.
+    template <class Database, Database& (*GetDatabase)()>
+    struct hash<foonathan::string_id::basic_string_id<Database, GetDatabase>>
+    {
+        typedef foonathan::string_id::basic_string_id<Database, GetDatabase> argument_type;
+        typedef size_t result_type;
+
+        result_type operator()(const argument_type &arg) const FOONATHAN_NOEXCEPT
+        {
+            return static_cast<result_type>(arg.hash_code());
+        }
+    };
+} // namspace std
+
+#endif // FOONATHAN_STRING_ID_BASIC_STRING_ID_HPP_INCLUDED
@@ -0,0 +1,66 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// compares the recursive hash function used for the literal with the iterative one used at runtime
+// output is CSV: function,length,strings,seconds,bytes_per_second
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../hash.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    const std::size_t no_strings = 1024u;
+    const std::size_t no_rounds = 1000u;
+
+    std::vector<std::string> make_strings(std::size_t length)
+    {
+        std::vector<std::string> result;
+        for (std::size_t i = 0u; i != no_strings; ++i)
+        {
+            auto str = "identifier_" + std::to_string(i);
+            str.resize(length, 'x');
+            result.push_back(str);
+        }
+        return result;
+    }
+
+    template <typename Fnc>
+    void run(const char *name, const std::vector<std::string> &strings, Fnc fnc)
+    {
+        volatile sid::hash_type sink = 0u;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t round = 0u; round != no_rounds; ++round)
+            for (auto &str : strings)
+                sink = sink + fnc(str);
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration<double>(end - start).count();
+        auto length = strings.front().size();
+        std::printf("%s,%zu,%zu,%f,%f\n", name, length, no_rounds * no_strings, seconds,
+                    no_rounds * no_strings * length / seconds);
+    }
+}
+
+int main()
+{
+    std::printf("function,length,strings,seconds,bytes_per_second\n");
+    for (auto length : {8u, 32u, 256u})
+    {
+        auto strings = make_strings(length);
+        run("sid_hash", strings, [](const std::string &str)
+            {
+                return sid::detail::sid_hash(str.c_str());
+            });
+        run("sid_hash_n", strings, [](const std::string &str)
+            {
+                return sid::detail::sid_hash_n(str.c_str(), str.size());
+            });
+    }
+}
@@ -0,0 +1,294 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// compares the performance of the databases with each other and a std::unordered_map
+// usage: foonathan_string_id_bench [number of strings]
+// output is CSV: benchmark,database,input,operations,seconds,ns_per_operation,bytes
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../database.hpp"
+#include "../generator.hpp"
+#include "../string_id.hpp"
+#include "../string_id_map.hpp"
+
+namespace sid = foonathan::string_id;
+
+//=== memory tracking ===//
+namespace
+{
+    // number of bytes currently allocated via operator new
+    std::size_t allocated_bytes = 0u;
+
+    // each allocation stores its size in front of the memory
+    union allocation_header
+    {
+        std::size_t size;
+        std::max_align_t alignment;
+    };
+}
+
+void* operator new(std::size_t size)
+{
+    auto mem = std::malloc(sizeof(allocation_header) + size);
+    if (!mem)
+        throw std::bad_alloc();
+    auto header = static_cast<allocation_header*>(mem);
+    header->size = size;
+    allocated_bytes += size;
+    return header + 1;
+}
+
+void operator delete(void *ptr) FOONATHAN_NOEXCEPT
+{
+    if (!ptr)
+        return;
+    auto header = static_cast<allocation_header*>(ptr) - 1;
+    allocated_bytes -= header->size;
+    std::free(header);
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void operator delete[](void *ptr) FOONATHAN_NOEXCEPT
+{
+    ::operator delete(ptr);
+}
+
+//=== std::unordered_map ===//
+namespace
+{
+    // the std::unordered_map implementation the map_database is compared with
+    class unordered_map_database : public sid::basic_database
+    {
+    public:
+        insert_status insert(sid::hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE
+        {
+            auto iter = map_.find(hash);
+            if (iter != map_.end())
+                return iter->second.compare(0, std::string::npos, str, length) == 0 ? old_string : collision;
+            map_.emplace(hash, std::string(str, length));
+            return new_string;
+        }
+
+        const char* lookup(sid::hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return map_.find(hash)->second.c_str();
+        }
+
+    private:
+        std::unordered_map<sid::hash_type, std::string> map_;
+    };
+}
+
+//=== input ===//
+namespace
+{
+    // random lower case words with 3 to 12 characters
+    std::vector<std::string> make_words(std::size_t n)
+    {
+        std::mt19937 rng(42u);
+        std::uniform_int_distribution<std::size_t> length(3u, 12u);
+        std::uniform_int_distribution<int> character('a', 'z');
+        std::vector<std::string> result;
+        result.reserve(n);
+        for (std::size_t i = 0u; i != n; ++i)
+        {
+            std::string word(length(rng), ' ');
+            for (auto &c : word)
+                c = static_cast<char>(character(rng));
+            result.push_back(word);
+        }
+        return result;
+    }
+
+    std::vector<std::string> make_entities(std::size_t n)
+    {
+        std::vector<std::string> result;
+        result.reserve(n);
+        for (std::size_t i = 0u; i != n; ++i)
+            result.push_back("entity-" + std::to_string(i));
+        return result;
+    }
+
+    // the suffixes of make_entities() for insert_prefix
+    std::vector<std::string> make_suffixes(std::size_t n)
+    {
+        std::vector<std::string> result;
+        result.reserve(n);
+        for (std::size_t i = 0u; i != n; ++i)
+            result.push_back(std::to_string(i));
+        return result;
+    }
+}
+
+//=== benchmarks ===//
+namespace
+{
+    class timer
+    {
+    public:
+        timer()
+        : start_(std::chrono::steady_clock::now()) {}
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    void report(const char *benchmark, const char *database, const char *input,
+                std::size_t operations, double seconds, std::size_t bytes)
+    {
+        std::printf("%s,%s,%s,%zu,%f,%f,%zu\n", benchmark, database, input,
+                    operations, seconds, seconds * 1e9 / operations, bytes);
+    }
+
+    // volatile sink so that the compiler can't optimize lookups away
+    volatile std::size_t sink = 0u;
+
+    template <class Database>
+    void run_insert(const char *name, const char *input, const std::vector<std::string> &strings)
+    {
+        std::vector<sid::string_id> ids;
+        ids.reserve(strings.size());
+        auto memory = allocated_bytes;
+        Database db;
+
+        {
+            timer t;
+            for (auto &str : strings)
+                ids.push_back(sid::string_id(sid::string_info(str.c_str(), str.size()), db));
+            report("insert_new", name, input, strings.size(), t.seconds(),
+                   allocated_bytes - memory + sizeof(Database));
+        }
+
+        {
+            timer t;
+            for (auto &str : strings)
+                sid::string_id(sid::string_info(str.c_str(), str.size()), db);
+            report("insert_existing", name, input, strings.size(), t.seconds(), 0u);
+        }
+
+        {
+            timer t;
+            for (auto &id : ids)
+                sink = sink + static_cast<std::size_t>(id.string()[0]);
+            report("lookup", name, input, ids.size(), t.seconds(), 0u);
+        }
+    }
+
+    template <class Database>
+    void run_insert_prefix(const char *name, const std::vector<std::string> &suffixes)
+    {
+        Database db;
+        sid::string_id prefix("entity-", db);
+        auto memory = allocated_bytes;
+
+        timer t;
+        for (auto &str : suffixes)
+            sid::string_id(prefix, sid::string_info(str.c_str(), str.size()));
+        report("insert_prefix", name, "entities", suffixes.size(), t.seconds(), allocated_bytes - memory);
+    }
+
+    template <class Database>
+    void run_generator(const char *name, std::size_t n)
+    {
+        {
+            Database db;
+            sid::counter_generator generator(sid::string_id("entity-", db));
+            timer t;
+            for (std::size_t i = 0u; i != n; ++i)
+                generator();
+            report("counter_generator", name, "entities", n, t.seconds(), 0u);
+        }
+
+        {
+            Database db;
+            sid::random_generator<std::mt19937, 8> generator(sid::string_id("entity-", db));
+            timer t;
+            for (std::size_t i = 0u; i != n; ++i)
+                generator();
+            report("random_generator", name, "entities", n, t.seconds(), 0u);
+        }
+    }
+
+    // string_id -> value containers
+    template <class Map>
+    void run_map(const char *name, const std::vector<std::string> &strings)
+    {
+        sid::map_database db;
+        std::vector<sid::string_id> ids;
+        ids.reserve(strings.size());
+        for (auto &str : strings)
+            ids.push_back(sid::string_id(sid::string_info(str.c_str(), str.size()), db));
+
+        auto memory = allocated_bytes;
+        Map map;
+        {
+            timer t;
+            for (std::size_t i = 0u; i != ids.size(); ++i)
+                map.emplace(ids[i], i);
+            report("map_insert", name, "entities", ids.size(), t.seconds(), allocated_bytes - memory);
+        }
+
+        {
+            timer t;
+            for (auto &id : ids)
+                sink = sink + map.find(id)->second;
+            report("map_find", name, "entities", ids.size(), t.seconds(), 0u);
+        }
+    }
+
+    template <class Database>
+    void run(const char *name, std::size_t n, const std::vector<std::string> &words,
+             const std::vector<std::string> &entities, const std::vector<std::string> &suffixes)
+    {
+        run_insert<Database>(name, "words", words);
+        run_insert<Database>(name, "entities", entities);
+        run_insert_prefix<Database>(name, suffixes);
+        run_generator<Database>(name, n);
+    }
+
+    // map_database using arena storage
+    class arena_map_database : public sid::map_database
+    {
+    public:
+        arena_map_database()
+        : map_database(1024, 1.0, arena_storage) {}
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000u;
+    auto words = make_words(n);
+    auto entities = make_entities(n);
+    auto suffixes = make_suffixes(n);
+
+    std::printf("benchmark,database,input,operations,seconds,ns_per_operation,bytes\n");
+    run<sid::dummy_database>("dummy_database", n, words, entities, suffixes);
+    run<sid::map_database>("map_database", n, words, entities, suffixes);
+    run<arena_map_database>("map_database(arena_storage)", n, words, entities, suffixes);
+    run<sid::thread_safe_database<sid::map_database>>("thread_safe_database<map_database>", n, words, entities, suffixes);
+    run<sid::flat_map_database>("flat_map_database", n, words, entities, suffixes);
+    run<sid::concurrent_database>("concurrent_database", n, words, entities, suffixes);
+    run<unordered_map_database>("std::unordered_map", n, words, entities, suffixes);
+
+    run_map<sid::string_id_map<std::size_t>>("string_id_map", entities);
+    run_map<std::unordered_map<sid::string_id, std::size_t>>("std::unordered_map", entities);
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// measures the throughput of concurrent string_id creation and lookups depending on the number of threads
+// and of random generators shared by all threads
+// the maximum number of threads can be given as argument, default is the number of cores
+// output is CSV: database,threads,operations,seconds,operations_per_second
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../database.hpp"
+#include "../generator.hpp"
+#include "../string_id.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    const std::size_t no_names = 100000u;
+
+    // each thread creates its own names, every name is inserted twice
+    std::vector<std::vector<std::string>> make_names(std::size_t no_threads)
+    {
+        std::vector<std::vector<std::string>> result(no_threads);
+        for (std::size_t t = 0u; t != no_threads; ++t)
+            for (std::size_t i = 0u; i != no_names / no_threads; ++i)
+                result[t].push_back("entity-" + std::to_string(t) + '-' + std::to_string(i));
+        return result;
+    }
+
+    template <class Database>
+    void run(const char *name, std::size_t no_threads)
+    {
+        auto names = make_names(no_threads);
+        Database db;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0u; t != no_threads; ++t)
+            threads.emplace_back([&, t]
+                                 {
+                                     for (auto round = 0; round != 2; ++round)
+                                         for (auto &str : names[t])
+                                             sid::string_id(sid::string_info(str.c_str(), str.size()), db);
+                                 });
+        for (auto &thread : threads)
+            thread.join();
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration<double>(end - start).count();
+        auto operations = 2 * (no_names / no_threads) * no_threads;
+        std::printf("%s,%zu,%zu,%f,%f\n", name, no_threads, operations, seconds, operations / seconds);
+    }
+
+    // all names are inserted first, then each thread looks up its names repeatedly
+    template <class Database>
+    void run_lookup(const char *name, std::size_t no_threads)
+    {
+        static const auto no_rounds = 4;
+
+        auto names = make_names(no_threads);
+        Database db;
+        std::vector<std::vector<sid::hash_type>> hashes(no_threads);
+        for (std::size_t t = 0u; t != no_threads; ++t)
+            for (auto &str : names[t])
+                hashes[t].push_back(sid::string_id(sid::string_info(str.c_str(), str.size()), db).hash_code());
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        std::vector<std::size_t> sums(no_threads);
+        for (std::size_t t = 0u; t != no_threads; ++t)
+            threads.emplace_back([&, t]
+                                 {
+                                     std::size_t sum = 0u;
+                                     for (auto round = 0; round != no_rounds; ++round)
+                                         for (auto hash : hashes[t])
+                                             sum += *db.lookup(hash);
+                                     sums[t] = sum; // so the lookups can't be optimized away
+                                 });
+        for (auto &thread : threads)
+            thread.join();
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration<double>(end - start).count();
+        auto operations = no_rounds * (no_names / no_threads) * no_threads;
+        std::printf("%s,%zu,%zu,%f,%f\n", name, no_threads, operations, seconds, operations / seconds);
+    }
+
+    typedef sid::sharded_database<sid::map_database, 16> generator_database;
+
+    // random_generator is not thread safe, so it has to be locked
+    class locked_random_generator
+    {
+    public:
+        explicit locked_random_generator(const sid::string_id &prefix)
+        : generator_(prefix) {}
+
+        sid::string_id operator()()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return generator_();
+        }
+
+    private:
+        sid::random_generator<std::mt19937, 12> generator_;
+        std::mutex mutex_;
+    };
+
+    template <class Generator>
+    void run_generator(const char *name, std::size_t no_threads)
+    {
+        generator_database db;
+        Generator generator(sid::string_id("entity-", db));
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0u; t != no_threads; ++t)
+            threads.emplace_back([&]
+                                 {
+                                     for (std::size_t i = 0u; i != no_names / no_threads; ++i)
+                                         generator();
+                                 });
+        for (auto &thread : threads)
+            thread.join();
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration<double>(end - start).count();
+        auto operations = (no_names / no_threads) * no_threads;
+        std::printf("%s,%zu,%zu,%f,%f\n", name, no_threads, operations, seconds, operations / seconds);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::size_t max_threads = argc > 1 ? std::stoul(argv[1])
+                                       : std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("database,threads,operations,seconds,operations_per_second\n");
+    for (std::size_t no_threads = 1u;; no_threads = std::min(2 * no_threads, max_threads))
+    {
+        run<sid::thread_safe_database<sid::map_database>>("thread_safe_database<map_database>", no_threads);
+        run<sid::thread_safe_database<sid::map_database, sid::spin_lock>>
+            ("thread_safe_database<map_database, spin_lock>", no_threads);
+        run<sid::thread_safe_database<sid::map_database, sid::ticket_lock>>
+            ("thread_safe_database<map_database, ticket_lock>", no_threads);
+        run<sid::thread_safe_database<sid::map_database, sid::shared_spin_lock>>
+            ("thread_safe_database<map_database, shared_spin_lock>", no_threads);
+        run<sid::sharded_database<sid::map_database, 16>>("sharded_database<map_database, 16>", no_threads);
+        run<sid::sharded_database<sid::map_database, 64>>("sharded_database<map_database, 64>", no_threads);
+        run<sid::concurrent_database>("concurrent_database", no_threads);
+        run_lookup<sid::thread_safe_database<sid::map_database>>("lookup thread_safe_database<map_database>", no_threads);
+        run_lookup<sid::thread_safe_database<sid::map_database, sid::spin_lock>>
+            ("lookup thread_safe_database<map_database, spin_lock>", no_threads);
+        run_lookup<sid::thread_safe_database<sid::map_database, sid::ticket_lock>>
+            ("lookup thread_safe_database<map_database, ticket_lock>", no_threads);
+        run_lookup<sid::thread_safe_database<sid::map_database, sid::shared_spin_lock>>
+            ("lookup thread_safe_database<map_database, shared_spin_lock>", no_threads);
+        run_lookup<sid::concurrent_database>("lookup concurrent_database", no_threads);
+        run_generator<locked_random_generator>("random_generator+mutex", no_threads);
+        run_generator<sid::concurrent_random_generator<std::mt19937, 12>>("concurrent_random_generator", no_threads);
+        if (no_threads == max_threads)
+            break;
+    }
+}
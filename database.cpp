@@ -4,22 +4,132 @@
 
 #include "database.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <new>
 #include <string>
 
+#if defined(__AVX2__)
+    #define FOONATHAN_STRING_ID_IMPL_AVX2 1
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define FOONATHAN_STRING_ID_IMPL_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define FOONATHAN_STRING_ID_IMPL_PREFETCH(Addr) __builtin_prefetch(Addr)
+#elif FOONATHAN_STRING_ID_IMPL_SSE2 || FOONATHAN_STRING_ID_IMPL_AVX2
+    #define FOONATHAN_STRING_ID_IMPL_PREFETCH(Addr) _mm_prefetch(reinterpret_cast<const char*>(Addr), _MM_HINT_T0)
+#else
+    #define FOONATHAN_STRING_ID_IMPL_PREFETCH(Addr)
+#endif
+
 namespace sid = foonathan::string_id;
 
+namespace
+{
+    // 0 is never used, so a zero-initialized cache entry is never valid
+    std::atomic<std::uint64_t> next_cache_id(1u);
+}
+
+sid::basic_database::basic_database() FOONATHAN_NOEXCEPT
+: cache_id_(next_cache_id.fetch_add(1u, std::memory_order_relaxed)) {}
+
+void sid::basic_database::invalidate_caches() FOONATHAN_NOEXCEPT
+{
+    cache_id_.store(next_cache_id.fetch_add(1u, std::memory_order_relaxed), std::memory_order_release);
+}
+
 sid::basic_database::insert_status sid::basic_database::insert_prefix(hash_type hash, hash_type prefix,
                                                                       const char *str, std::size_t length)
 {
-    std::string prefix_str = lookup(prefix);
-    return insert(hash, (prefix_str + str).c_str(), prefix_str.size() + length);
+    std::string full = lookup(prefix);
+    full.append(str, length);
+    return insert(hash, full.c_str(), full.size());
+}
+
+sid::basic_database::insert_status sid::basic_database::insert_segments(hash_type hash, const string_info *segments,
+                                                                        std::size_t count)
+{
+    assert(count != 0u);
+    if (count == 1u)
+        return insert(hash, segments[0].string, segments[0].length);
+    auto str = detail::concatenate(segments, count);
+    return insert(hash, str.c_str(), str.size());
+}
+
+std::string sid::detail::concatenate(const string_info *segments, std::size_t count)
+{
+    std::size_t length = 0u;
+    for (auto cur = segments; cur != segments + count; ++cur)
+        length += cur->length;
+    std::string result;
+    result.reserve(length);
+    for (auto cur = segments; cur != segments + count; ++cur)
+        result.append(cur->string, cur->length);
+    return result;
+}
+
+bool sid::basic_database::erase(hash_type)
+{
+    return false;
+}
+
+const char* sid::basic_database::find(hash_type) const FOONATHAN_NOEXCEPT
+{
+    return nullptr;
+}
+
+FOONATHAN_CONSTEXPR std::size_t sid::database_statistics::histogram_size;
+
+sid::database_statistics sid::basic_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    return database_statistics();
+}
+
+void sid::basic_database::insert_batch(const hash_type *hashes, const string_info *strings,
+                                       insert_status *status, std::size_t count)
+{
+    for (std::size_t i = 0u; i != count; ++i)
+        status[i] = insert(hashes[i], strings[i].string, strings[i].length);
+}
+
+void sid::basic_database::insert_prefix_batch(const hash_type *hashes, hash_type prefix, const string_info *strings,
+                                              insert_status *status, std::size_t count)
+{
+    for (std::size_t i = 0u; i != count; ++i)
+        status[i] = insert_prefix(hashes[i], prefix, strings[i].string, strings[i].length);
 }
 
 namespace
 {
+    // adds the time of its lifetime to a counter
+    class timer
+    {
+    public:
+        explicit timer(std::uint64_t &nanoseconds) FOONATHAN_NOEXCEPT
+        : nanoseconds_(nanoseconds), start_(std::chrono::steady_clock::now()) {}
+
+        ~timer() FOONATHAN_NOEXCEPT
+        {
+            auto duration = std::chrono::steady_clock::now() - start_;
+            nanoseconds_ += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+    private:
+        std::uint64_t &nanoseconds_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
     // equivalent to prefix + str == other_str for std::string
     // prefix and other_str are null-terminated
     bool strequal(const char *prefix,
@@ -36,9 +146,57 @@ namespace
 /// \cond impl
 class sid::map_database::node_list
 {    
+    struct node;
+
+    // compares the segments of a node with other segments of the same total length
+    struct segment_compare
+    {
+        const string_info *cur;
+        std::size_t offset; // in cur
+        bool equal;
+
+        explicit segment_compare(const string_info *segments) FOONATHAN_NOEXCEPT
+        : cur(segments), offset(0u), equal(true) {}
+
+        void operator()(const char *str, std::size_t length) FOONATHAN_NOEXCEPT
+        {
+            while (equal && length)
+            {
+                if (offset == cur->length)
+                {
+                    // there are characters left, so there is a non-empty segment left as well
+                    do
+                        ++cur;
+                    while (cur->length == 0u);
+                    offset = 0u;
+                }
+                auto n = std::min(length, cur->length - offset);
+                equal = std::memcmp(str, cur->string + offset, n) == 0;
+                str += n;
+                length -= n;
+                offset += n;
+            }
+        }
+    };
+
+    // stored after the header of a node sharing its prefix, followed by the suffix
+    struct shared_data
+    {
+        const node *prefix; // nullptr if the prefix has been erased, full is set then
+        mutable std::atomic<char*> full; // the whole string, created on first use
+
+        explicit shared_data(const node *prefix) FOONATHAN_NOEXCEPT
+        : prefix(prefix), full(nullptr) {}
+    };
+
     struct node
     {
-        std::size_t length; // length of string
+        static FOONATHAN_CONSTEXPR std::size_t shared_flag = ~(~std::size_t(0u) >> 1);
+        static FOONATHAN_CONSTEXPR std::size_t prefix_flag = shared_flag >> 1;
+
+        // length of string, highest bit set if the prefix is shared,
+        // second highest bit set if it is the shared prefix of other nodes
+        std::size_t length;
         hash_type hash;
         node *next;
         
@@ -46,8 +204,7 @@ class sid::map_database::node_list
              hash_type h, node *next) FOONATHAN_NOEXCEPT
         : length(length), hash(h), next(next)
         {
-            void* mem = this;
-            auto dest = static_cast<char*>(mem) + sizeof(node);
+            auto dest = get_memory();
             std::strncpy(dest, str, length);
             dest[length] = 0;
         }
@@ -57,15 +214,181 @@ class sid::map_database::node_list
              hash_type h, node *next) FOONATHAN_NOEXCEPT
         : length(length_prefix + length_string), hash(h), next(next)
         {
-            void* mem = this;
-            auto dest = static_cast<char*>(mem) + sizeof(node);
+            auto dest = get_memory();
             std::strncpy(dest, prefix, length_prefix);
             dest += length_prefix;
             std::strncpy(dest, str, length_string);
             dest[length_string] = 0;
         }
+
+        node(const string_info *segments, std::size_t count, std::size_t length,
+             hash_type h, node *next) FOONATHAN_NOEXCEPT
+        : length(length), hash(h), next(next)
+        {
+            auto dest = get_memory();
+            for (auto cur = segments; cur != segments + count; ++cur)
+            {
+                std::memcpy(dest, cur->string, cur->length);
+                dest += cur->length;
+            }
+            *dest = 0;
+        }
+
+        node(const node *prefix, const char *str, std::size_t length_string,
+             hash_type h, node *next) FOONATHAN_NOEXCEPT
+        : length((prefix->get_length() + length_string) | shared_flag), hash(h), next(next)
+        {
+            ::new(static_cast<void*>(get_memory())) shared_data(prefix);
+            auto dest = const_cast<char*>(get_suffix());
+            std::memcpy(dest, str, length_string);
+            dest[length_string] = 0;
+        }
+
+        std::size_t get_length() const FOONATHAN_NOEXCEPT
+        {
+            return length & ~(shared_flag | prefix_flag);
+        }
+
+        bool is_shared() const FOONATHAN_NOEXCEPT
+        {
+            return (length & shared_flag) != 0u;
+        }
+
+        bool is_prefix() const FOONATHAN_NOEXCEPT
+        {
+            return (length & prefix_flag) != 0u;
+        }
+
+        shared_data& get_shared() FOONATHAN_NOEXCEPT
+        {
+            assert(is_shared());
+            void *mem = get_memory();
+            return *static_cast<shared_data*>(mem);
+        }
+
+        const shared_data& get_shared() const FOONATHAN_NOEXCEPT
+        {
+            assert(is_shared());
+            const void *mem = get_memory();
+            return *static_cast<const shared_data*>(mem);
+        }
+
+        const char* get_suffix() const FOONATHAN_NOEXCEPT
+        {
+            return get_memory() + sizeof(shared_data);
+        }
+
+        std::size_t get_suffix_length() const FOONATHAN_NOEXCEPT
+        {
+            auto prefix = get_shared().prefix;
+            return prefix ? get_length() - prefix->get_length() : std::strlen(get_suffix());
+        }
+
+        // size of the memory of the node
+        std::size_t get_size() const FOONATHAN_NOEXCEPT
+        {
+            return is_shared() ? sizeof(node) + sizeof(shared_data) + get_suffix_length() + 1
+                               : sizeof(node) + get_length() + 1;
+        }
         
+        // if the prefix is shared, the string is created on the first call
         const char* get_str() const FOONATHAN_NOEXCEPT
+        {
+            if (!is_shared())
+                return get_memory();
+            auto str = materialize();
+            return str ? str : "string_id map database: out of memory";
+        }
+
+        // creates the whole string of a node sharing its prefix, returns nullptr if out of memory
+        const char* materialize() const FOONATHAN_NOEXCEPT
+        {
+            auto &shared = get_shared();
+            if (auto str = shared.full.load(std::memory_order_acquire))
+                return str;
+            auto str = new(std::nothrow) char[get_length() + 1];
+            if (!str)
+                return nullptr;
+            auto cur = str;
+            auto append = [&](const char *segment, std::size_t length)
+                          {
+                              std::memcpy(cur, segment, length);
+                              cur += length;
+                          };
+            for_each_segment(append);
+            *cur = 0;
+            // another thread may have been faster
+            char *expected = nullptr;
+            if (shared.full.compare_exchange_strong(expected, str, std::memory_order_acq_rel))
+                return str;
+            delete[] str;
+            return expected;
+        }
+
+        // calls f(str, length) for each part of the string in order
+        template <typename Func>
+        void for_each_segment(Func &f) const
+        {
+            if (is_shared() && !get_shared().prefix)
+                f(get_shared().full.load(std::memory_order_relaxed), get_length());
+            else if (is_shared())
+            {
+                get_shared().prefix->for_each_segment(f);
+                f(get_suffix(), get_suffix_length());
+            }
+            else
+                f(get_memory(), get_length());
+        }
+
+        bool equal(const char *str, std::size_t length) const FOONATHAN_NOEXCEPT
+        {
+            if (!is_shared())
+                return std::strncmp(str, get_memory(), length) == 0;
+            else if (!get_shared().prefix)
+                return get_length() == length
+                    && std::memcmp(get_shared().full.load(std::memory_order_relaxed), str, length) == 0;
+            auto suffix_length = get_suffix_length();
+            return get_length() == length
+                && get_shared().prefix->equal(str, length - suffix_length)
+                && std::memcmp(get_suffix(), str + length - suffix_length, suffix_length) == 0;
+        }
+
+        // length is the total length of the segments
+        bool equal(const string_info *segments, std::size_t length) const FOONATHAN_NOEXCEPT
+        {
+            if (get_length() != length)
+                return false;
+            segment_compare compare(segments);
+            for_each_segment(compare);
+            return compare.equal;
+        }
+
+        bool equal(const node *prefix, const char *str, std::size_t length) const
+        {
+            if (is_shared() && get_shared().prefix == prefix)
+                return get_suffix_length() == length && std::memcmp(get_suffix(), str, length) == 0;
+            else if (!is_shared() && !prefix->is_shared())
+                return strequal(prefix->get_memory(), str, length, get_memory());
+
+            std::string full;
+            full.reserve(prefix->get_length() + length);
+            auto append = [&](const char *segment, std::size_t length)
+                          {
+                              full.append(segment, length);
+                          };
+            prefix->for_each_segment(append);
+            full.append(str, length);
+            return equal(full.c_str(), full.size());
+        }
+
+    private:
+        char* get_memory() FOONATHAN_NOEXCEPT
+        {
+            void* mem = this;
+            return static_cast<char*>(mem) + sizeof(node);
+        }
+
+        const char* get_memory() const FOONATHAN_NOEXCEPT
         {
             const void *mem = this;
             return static_cast<const char*>(mem) + sizeof(node);
@@ -90,9 +413,33 @@ class sid::map_database::node_list
     
 public:
     node_list() FOONATHAN_NOEXCEPT
-    : head_(nullptr) {}
+    : head_(nullptr), size_(0u) {}
+    
+    static FOONATHAN_CONSTEXPR_FNC std::size_t node_alignment() FOONATHAN_NOEXCEPT
+    {
+        return alignof(node);
+    }
+    
+    static FOONATHAN_CONSTEXPR_FNC std::size_t node_header_size() FOONATHAN_NOEXCEPT
+    {
+        return sizeof(node);
+    }
+    
+    std::size_t size() const FOONATHAN_NOEXCEPT
+    {
+        return size_;
+    }
     
-    ~node_list() FOONATHAN_NOEXCEPT
+    // frees the strings created for nodes sharing their prefix
+    void destroy_shared() FOONATHAN_NOEXCEPT
+    {
+        for (auto cur = head_; cur; cur = cur->next)
+            if (cur->is_shared())
+                delete[] cur->get_shared().full.load(std::memory_order_relaxed);
+    }
+
+    // frees all nodes, only called if they were allocated on the heap
+    void destroy() FOONATHAN_NOEXCEPT
     {
         auto cur = head_;
         while (cur)
@@ -101,49 +448,86 @@ public:
             ::operator delete(cur);
             cur = next;
         }
+        head_ = nullptr;
     }
     
-    basic_database::insert_status insert(hash_type hash, const char *str, std::size_t length)
+    basic_database::insert_status insert(map_database &db, hash_type hash, const char *str, std::size_t length)
     {
         auto pos = insert_pos(hash);
         if (pos.exists)
-            return std::strncmp(str, pos.cur->get_str(), length) == 0 ?
+            return pos.cur->equal(str, length) ?
                    basic_database::old_string : basic_database::collision;
-        auto mem = ::operator new(sizeof(node) + length + 1);
+        auto mem = db.allocate_node(sizeof(node) + length + 1);
         auto n = ::new(mem) node(str, length, hash, pos.next);
         pos.prev = n;
+        ++size_;
         return basic_database::new_string;
     }
     
-    basic_database::insert_status insert_prefix(node_list &prefix_bucket, hash_type prefix,
+    basic_database::insert_status insert_prefix(map_database &db, node_list &prefix_bucket, hash_type prefix,
                                                 hash_type hash, const char *str, std::size_t length)
     {
         auto prefix_node = prefix_bucket.find_node(prefix);
         auto pos = insert_pos(hash);
         if (pos.exists)
-            return strequal(prefix_node->get_str(), str, length, pos.cur->get_str()) ?
+            return pos.cur->equal(prefix_node, str, length) ?
                    basic_database::old_string : basic_database::collision;
-        auto mem = ::operator new(sizeof(node) + prefix_node->length + length + 1);
-        auto n = ::new(mem) node(prefix_node->get_str(), prefix_node->length,
-                                 str, length, hash, pos.next);
+        node *n;
+        if (db.share_prefixes_)
+        {
+            auto mem = db.allocate_node(sizeof(node) + sizeof(shared_data) + length + 1);
+            db.string_bytes_ -= sizeof(shared_data);
+            n = ::new(mem) node(prefix_node, str, length, hash, pos.next);
+            prefix_node->length |= node::prefix_flag;
+            ++db.no_shared_nodes_;
+        }
+        else
+        {
+            auto mem = db.allocate_node(sizeof(node) + prefix_node->get_length() + length + 1);
+            n = ::new(mem) node(prefix_node->get_str(), prefix_node->get_length(),
+                                str, length, hash, pos.next);
+        }
         pos.prev = n;
+        ++size_;
+        return basic_database::new_string;
+    }
+    
+    basic_database::insert_status insert_segments(map_database &db, hash_type hash,
+                                                  const string_info *segments, std::size_t count)
+    {
+        std::size_t length = 0u;
+        for (auto cur = segments; cur != segments + count; ++cur)
+            length += cur->length;
+        auto pos = insert_pos(hash);
+        if (pos.exists)
+            return pos.cur->equal(segments, length) ?
+                   basic_database::old_string : basic_database::collision;
+        auto mem = db.allocate_node(sizeof(node) + length + 1);
+        auto n = ::new(mem) node(segments, count, length, hash, pos.next);
+        pos.prev = n;
+        ++size_;
         return basic_database::new_string;
     }
     
     // inserts all nodes into new buckets, this list is empty afterwards
-    void rehash(node_list *buckets, std::size_t size) FOONATHAN_NOEXCEPT
+    void rehash(map_database &db, node_list *buckets, std::size_t size) FOONATHAN_NOEXCEPT
     {
+        db.chain_length_changed(size_, 0u);
         auto cur = head_;
         while (cur)
         {
             auto next = cur->next;
-            auto pos = buckets[cur->hash % size].insert_pos(cur->hash);
+            auto &bucket = buckets[cur->hash % size];
+            auto pos = bucket.insert_pos(cur->hash);
             assert(!pos.exists && "element can't be there already");
             pos.prev = cur;
             cur->next = pos.next;
+            db.chain_length_changed(bucket.size_, bucket.size_ + 1);
+            ++bucket.size_;
             cur = next;
         }
         head_ = nullptr;
+        size_ = 0u;
     }
     
     // returns element with hash, there must be one
@@ -151,8 +535,82 @@ public:
     {
         return find_node(h)->get_str();
     }
+
+    // returns nullptr if there is no element with hash
+    const char* find(hash_type h) const FOONATHAN_NOEXCEPT
+    {
+        auto cur = head_;
+        while (cur && cur->hash < h)
+            cur = cur->next;
+        return cur && cur->hash == h ? cur->get_str() : nullptr;
+    }
+
+    // removes the element with hash, returns false if there is none
+    bool erase(map_database &db, hash_type h)
+    {
+        auto link = &head_;
+        while (*link && (*link)->hash < h)
+            link = &(*link)->next;
+        auto n = *link;
+        if (!n || n->hash != h)
+            return false;
+
+        if (n->is_prefix())
+        {
+            // nodes sharing it as prefix need their own copy of the string
+            for (std::size_t i = 0u; i != db.no_buckets_; ++i)
+                db.buckets_[i].detach_prefix(n);
+            if (db.old_buckets_)
+                for (auto i = db.next_migration_; i != db.no_old_buckets_; ++i)
+                    db.old_buckets_[i].detach_prefix(n);
+        }
+
+        *link = n->next;
+        db.chain_length_changed(size_, size_ - 1);
+        --size_;
+        auto size = n->get_size();
+        db.string_bytes_ -= size - sizeof(node) - (n->is_shared() ? sizeof(shared_data) : 0u);
+        if (n->is_shared())
+        {
+            delete[] n->get_shared().full.load(std::memory_order_relaxed);
+            --db.no_shared_nodes_;
+        }
+        // arena memory is only freed by its destructor
+        if (db.policy_ == heap_storage)
+        {
+            ::operator delete(n);
+            db.bytes_used_ -= size;
+        }
+        return true;
+    }
+    
+    template <typename Func>
+    void for_each(Func &f) const
+    {
+        for (auto cur = head_; cur; cur = cur->next)
+            f(cur->hash, cur->get_str(), cur->get_length());
+    }
+
+    template <typename Func>
+    void for_each_segment(hash_type h, Func &f) const
+    {
+        find_node(h)->for_each_segment(f);
+    }
     
 private:
+    // creates the string of all nodes sharing the given prefix
+    // throws std::bad_alloc, but each node stays valid
+    void detach_prefix(const node *prefix)
+    {
+        for (auto cur = head_; cur; cur = cur->next)
+            if (cur->is_shared() && cur->get_shared().prefix == prefix)
+            {
+                if (!cur->materialize())
+                    throw std::bad_alloc();
+                cur->get_shared().prefix = nullptr;
+            }
+    }
+
     node* find_node(hash_type h) const FOONATHAN_NOEXCEPT
     {
         assert(head_ && "hash not inserted");
@@ -183,54 +641,816 @@ private:
     }
     
     node *head_;
+    std::size_t size_;
 };
 /// \endcond
 
-sid::map_database::map_database(std::size_t size, double max_load_factor)
+sid::map_database::map_database(std::size_t size, double max_load_factor, storage_policy policy)
 : buckets_(new node_list[size]),
   no_items_(0u), no_buckets_(size),
   max_load_factor_(max_load_factor),
-  next_resize_(static_cast<std::size_t>(std::floor(no_buckets_ * max_load_factor_)))
-{}
+  next_resize_(static_cast<std::size_t>(std::floor(no_buckets_ * max_load_factor_))),
+  no_old_buckets_(0u), next_migration_(0u), rehash_step_(0u),
+  bytes_used_(0u), policy_(policy), share_prefixes_(false), no_shared_nodes_(0u),
+  string_bytes_(0u), no_collisions_(0u), no_rehashes_(0u), rehash_nanoseconds_(0u)
+{
+    std::fill(chain_lengths_, chain_lengths_ + database_statistics::histogram_size, 0u);
+    chain_lengths_[0] = no_buckets_;
+}
+
+sid::map_database::~map_database() FOONATHAN_NOEXCEPT
+{
+    if (no_shared_nodes_ != 0u)
+    {
+        auto end = buckets_.get() + no_buckets_;
+        for (auto list = buckets_.get(); list != end; ++list)
+            list->destroy_shared();
+        if (old_buckets_)
+            for (auto i = next_migration_; i != no_old_buckets_; ++i)
+                old_buckets_[i].destroy_shared();
+    }
 
-sid::map_database::~map_database() FOONATHAN_NOEXCEPT {}
+    // arena memory is freed all at once by its destructor
+    if (policy_ == heap_storage)
+    {
+        auto end = buckets_.get() + no_buckets_;
+        for (auto list = buckets_.get(); list != end; ++list)
+            list->destroy();
+        if (old_buckets_)
+            for (auto i = next_migration_; i != no_old_buckets_; ++i)
+                old_buckets_[i].destroy();
+    }
+}
 
 sid::basic_database::insert_status sid::map_database::insert(hash_type hash, const char *str, std::size_t length)
 {
-    if (no_items_ + 1 >= next_resize_)
-        rehash();
-    auto status = buckets_[hash % no_buckets_].insert(hash, str, length);
-    if (status == insert_status::new_string)
-        ++no_items_;
+    prepare_insert();
+    auto &bucket = get_bucket(hash);
+    auto status = bucket.insert(*this, hash, str, length);
+    inserted(bucket, status);
     return status;
 }
 
 sid::basic_database::insert_status sid::map_database::insert_prefix(hash_type hash, hash_type prefix,
                                                                     const char *str, std::size_t length)
 {
-    if (no_items_ + 1 >= next_resize_)
-        rehash();
-    auto status = buckets_[hash % no_buckets_].insert_prefix(buckets_[prefix % no_buckets_], prefix,
-                                                             hash, str, length);
-    if (status == insert_status::new_string)
-        ++no_items_;
+    prepare_insert();
+    auto &bucket = get_bucket(hash);
+    auto status = bucket.insert_prefix(*this, get_bucket(prefix), prefix,
+                                       hash, str, length);
+    inserted(bucket, status);
+    return status;
+}
+
+sid::basic_database::insert_status sid::map_database::insert_segments(hash_type hash, const string_info *segments,
+                                                                      std::size_t count)
+{
+    prepare_insert();
+    auto &bucket = get_bucket(hash);
+    auto status = bucket.insert_segments(*this, hash, segments, count);
+    inserted(bucket, status);
     return status;
 }
 
+void sid::map_database::insert_batch(const hash_type *hashes, const string_info *strings,
+                                     insert_status *status, std::size_t count)
+{
+    // the insertions can't trigger a rehash anymore
+    reserve(no_items_ + count);
+
+    // number of strings the prefetching is ahead
+    static FOONATHAN_CONSTEXPR std::size_t prefetch_distance = 8u;
+    for (std::size_t i = 0u; i != count && i != prefetch_distance; ++i)
+        FOONATHAN_STRING_ID_IMPL_PREFETCH(&buckets_[hashes[i] % no_buckets_]);
+    for (std::size_t i = 0u; i != count; ++i)
+    {
+        if (i + prefetch_distance < count)
+            FOONATHAN_STRING_ID_IMPL_PREFETCH(&buckets_[hashes[i + prefetch_distance] % no_buckets_]);
+        auto &bucket = buckets_[hashes[i] % no_buckets_];
+        status[i] = bucket.insert(*this, hashes[i], strings[i].string, strings[i].length);
+        inserted(bucket, status[i]);
+    }
+}
+
+void sid::map_database::insert_prefix_batch(const hash_type *hashes, hash_type prefix, const string_info *strings,
+                                            insert_status *status, std::size_t count)
+{
+    // the insertions can't trigger a rehash anymore, so the bucket of the prefix stays the same
+    reserve(no_items_ + count);
+    auto &prefix_bucket = buckets_[prefix % no_buckets_];
+
+    static FOONATHAN_CONSTEXPR std::size_t prefetch_distance = 8u;
+    for (std::size_t i = 0u; i != count && i != prefetch_distance; ++i)
+        FOONATHAN_STRING_ID_IMPL_PREFETCH(&buckets_[hashes[i] % no_buckets_]);
+    for (std::size_t i = 0u; i != count; ++i)
+    {
+        if (i + prefetch_distance < count)
+            FOONATHAN_STRING_ID_IMPL_PREFETCH(&buckets_[hashes[i + prefetch_distance] % no_buckets_]);
+        auto &bucket = buckets_[hashes[i] % no_buckets_];
+        status[i] = bucket.insert_prefix(*this, prefix_bucket, prefix,
+                                         hashes[i], strings[i].string, strings[i].length);
+        inserted(bucket, status[i]);
+    }
+}
+
 const char* sid::map_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
 {
-    return buckets_[hash % no_buckets_].lookup(hash);
+    return get_bucket(hash).lookup(hash);
+}
+
+bool sid::map_database::erase(hash_type hash)
+{
+    if (!get_bucket(hash).erase(*this, hash))
+        return false;
+    --no_items_;
+    invalidate_caches();
+    return true;
+}
+
+const char* sid::map_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    return get_bucket(hash).find(hash);
+}
+
+sid::database_statistics sid::map_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    database_statistics result;
+    result.no_strings = no_items_;
+    result.no_buckets = no_buckets_ + no_old_buckets_;
+    std::copy(chain_lengths_, chain_lengths_ + database_statistics::histogram_size, result.chain_length);
+    result.string_bytes = string_bytes_;
+    result.overhead_bytes = bytes_reserved() - string_bytes_ + result.no_buckets * sizeof(node_list);
+    result.no_collisions = no_collisions_;
+    result.no_rehashes = no_rehashes_;
+    result.rehash_nanoseconds = rehash_nanoseconds_;
+    return result;
+}
+
+void sid::map_database::for_each(const std::function<void(hash_type, const char*, std::size_t)> &f) const
+{
+    for (std::size_t i = 0u; i != no_buckets_; ++i)
+        buckets_[i].for_each(f);
+    for (auto i = next_migration_; i < no_old_buckets_; ++i)
+        old_buckets_[i].for_each(f);
+}
+
+void sid::map_database::for_each_segment(hash_type hash,
+                                         const std::function<void(const char*, std::size_t)> &f) const
+{
+    get_bucket(hash).for_each_segment(hash, f);
+}
+
+std::size_t sid::map_database::bytes_reserved() const FOONATHAN_NOEXCEPT
+{
+    return policy_ == arena_storage ? arena_.bytes_reserved() : bytes_used_;
+}
+
+std::size_t sid::map_database::bytes_used() const FOONATHAN_NOEXCEPT
+{
+    return policy_ == arena_storage ? arena_.bytes_used() : bytes_used_;
+}
+
+void sid::map_database::set_incremental_rehash(std::size_t buckets_per_insert) FOONATHAN_NOEXCEPT
+{
+    rehash_step_ = buckets_per_insert;
+}
+
+void sid::map_database::finish_rehash() FOONATHAN_NOEXCEPT
+{
+    if (old_buckets_)
+        migrate(no_old_buckets_);
+}
+
+double sid::map_database::rehash_progress() const FOONATHAN_NOEXCEPT
+{
+    return old_buckets_ ? double(next_migration_) / no_old_buckets_ : 1.0;
 }
 
-void sid::map_database::rehash()
+void* sid::map_database::allocate_node(std::size_t size)
+{
+    string_bytes_ += size - node_list::node_header_size();
+    if (policy_ == arena_storage)
+        return arena_.allocate(size, node_list::node_alignment());
+    auto mem = ::operator new(size);
+    bytes_used_ += size;
+    return mem;
+}
+
+void sid::map_database::inserted(const node_list &bucket, insert_status status) FOONATHAN_NOEXCEPT
+{
+    if (status == insert_status::new_string)
+    {
+        ++no_items_;
+        chain_length_changed(bucket.size() - 1, bucket.size());
+    }
+    else if (status == insert_status::collision)
+        ++no_collisions_;
+}
+
+void sid::map_database::chain_length_changed(std::size_t old_length, std::size_t new_length) FOONATHAN_NOEXCEPT
+{
+    static FOONATHAN_CONSTEXPR auto max = database_statistics::histogram_size - 1;
+    --chain_lengths_[old_length < max ? old_length : max];
+    ++chain_lengths_[new_length < max ? new_length : max];
+}
+
+sid::map_database::node_list& sid::map_database::get_bucket(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (old_buckets_)
+    {
+        // buckets that haven't been migrated yet are still used
+        auto i = hash % no_old_buckets_;
+        if (i >= next_migration_)
+            return old_buckets_[i];
+    }
+    return buckets_[hash % no_buckets_];
+}
+
+void sid::map_database::prepare_insert()
 {
     static FOONATHAN_CONSTEXPR auto growth_factor = 2;
-    auto new_size = growth_factor * no_buckets_;
-    auto buckets = new node_list[new_size]();
-    auto end = buckets_.get() + no_buckets_;
-    for (auto list = buckets_.get(); list != end; ++list)
-        list->rehash(buckets, new_size);
-    buckets_.reset(buckets);
+    if (no_items_ + 1 >= next_resize_)
+    {
+        // a new rehash can only start once the previous one is finished
+        finish_rehash();
+        rehash(growth_factor * no_buckets_);
+    }
+    else if (old_buckets_)
+        migrate(rehash_step_ ? rehash_step_ : no_old_buckets_);
+}
+
+void sid::map_database::reserve(std::size_t no_items)
+{
+    finish_rehash();
+    if (no_items < next_resize_)
+        return;
+
+    auto new_size = no_buckets_;
+    while (static_cast<std::size_t>(std::floor(new_size * max_load_factor_)) <= no_items)
+        new_size *= 2;
+    rehash(new_size);
+    finish_rehash();
+}
+
+void sid::map_database::rehash(std::size_t new_size)
+{
+    timer t(rehash_nanoseconds_);
+    std::unique_ptr<node_list[]> buckets(new node_list[new_size]());
+    chain_lengths_[0] += new_size;
+    ++no_rehashes_;
+    old_buckets_ = std::move(buckets_);
+    buckets_ = std::move(buckets);
+    no_old_buckets_ = no_buckets_;
     no_buckets_ = new_size;
+    next_migration_ = 0u;
     next_resize_ = static_cast<std::size_t>(std::floor(no_buckets_ * max_load_factor_));
+    // without incremental rehashing, everything is migrated at once
+    migrate(rehash_step_ ? rehash_step_ : no_old_buckets_);
+}
+
+void sid::map_database::migrate(std::size_t no_buckets) FOONATHAN_NOEXCEPT
+{
+    assert(old_buckets_);
+    timer t(rehash_nanoseconds_);
+    auto end = no_old_buckets_ - next_migration_ < no_buckets ? no_old_buckets_ : next_migration_ + no_buckets;
+    for (; next_migration_ != end; ++next_migration_)
+        old_buckets_[next_migration_].rehash(*this, buckets_.get(), no_buckets_);
+    if (next_migration_ == no_old_buckets_)
+    {
+        // all old buckets are empty now
+        chain_lengths_[0] -= no_old_buckets_;
+        old_buckets_.reset();
+        no_old_buckets_ = next_migration_ = 0u;
+    }
+}
+
+namespace
+{
+    // control bytes of flat_map_database
+    // full slots store the lower 7 bits of the hash, so they are always non-negative
+    FOONATHAN_CONSTEXPR signed char ctrl_empty = -128;
+    FOONATHAN_CONSTEXPR signed char ctrl_deleted = -2;
+
+    std::size_t count_trailing_zeros(std::uint32_t mask) FOONATHAN_NOEXCEPT
+    {
+        assert(mask != 0u);
+    #if defined(__GNUC__) || defined(__clang__)
+        return static_cast<std::size_t>(__builtin_ctz(mask));
+    #elif defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return index;
+    #else
+        std::size_t result = 0u;
+        for (; (mask & 1u) == 0u; mask >>= 1)
+            ++result;
+        return result;
+    #endif
+    }
+
+    // a group of control bytes that are probed at once
+    // match functions return a bitmask with bit i set if byte i matches
+#if FOONATHAN_STRING_ID_IMPL_AVX2
+    class ctrl_group
+    {
+    public:
+        static FOONATHAN_CONSTEXPR std::size_t width = 32u;
+
+        explicit ctrl_group(const signed char *ctrl) FOONATHAN_NOEXCEPT
+        : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl))) {}
+
+        std::uint32_t match(signed char value) const FOONATHAN_NOEXCEPT
+        {
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(value), ctrl_)));
+        }
+
+    private:
+        __m256i ctrl_;
+    };
+#elif FOONATHAN_STRING_ID_IMPL_SSE2
+    class ctrl_group
+    {
+    public:
+        static FOONATHAN_CONSTEXPR std::size_t width = 16u;
+
+        explicit ctrl_group(const signed char *ctrl) FOONATHAN_NOEXCEPT
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+        std::uint32_t match(signed char value) const FOONATHAN_NOEXCEPT
+        {
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(value), ctrl_)));
+        }
+
+    private:
+        __m128i ctrl_;
+    };
+#else
+    class ctrl_group
+    {
+    public:
+        static FOONATHAN_CONSTEXPR std::size_t width = 8u;
+
+        explicit ctrl_group(const signed char *ctrl) FOONATHAN_NOEXCEPT
+        {
+            std::memcpy(ctrl_, ctrl, width);
+        }
+
+        std::uint32_t match(signed char value) const FOONATHAN_NOEXCEPT
+        {
+            std::uint32_t result = 0u;
+            for (std::size_t i = 0u; i != width; ++i)
+                result |= std::uint32_t(ctrl_[i] == value) << i;
+            return result;
+        }
+
+    private:
+        signed char ctrl_[width];
+    };
+#endif
+
+    // number of zero bits before the highest set bit of a group mask
+    std::size_t count_leading_zeros(std::uint32_t mask) FOONATHAN_NOEXCEPT
+    {
+        assert(mask != 0u);
+        std::size_t result = 0u;
+        for (auto bit = std::uint32_t(1u) << (ctrl_group::width - 1u); (mask & bit) == 0u; bit >>= 1)
+            ++result;
+        return result;
+    }
+
+    signed char ctrl_hash(sid::hash_type hash) FOONATHAN_NOEXCEPT
+    {
+        return static_cast<signed char>(hash & 0x7F);
+    }
+
+    std::size_t slot_hash(sid::hash_type hash) FOONATHAN_NOEXCEPT
+    {
+        return static_cast<std::size_t>(hash >> 7);
+    }
+
+    std::size_t max_items(std::size_t capacity) FOONATHAN_NOEXCEPT
+    {
+        // maximum load factor of 7/8
+        return capacity - capacity / 8;
+    }
+
+    // the string is stored after its length
+    const char* allocate_string(const char *prefix, std::size_t length_prefix,
+                                const char *str, std::size_t length_string)
+    {
+        auto mem = ::operator new(sizeof(std::size_t) + length_prefix + length_string + 1);
+        auto length = static_cast<std::size_t*>(mem);
+        *length = length_prefix + length_string;
+        auto dest = static_cast<char*>(mem) + sizeof(std::size_t);
+        std::memcpy(dest, prefix, length_prefix);
+        std::memcpy(dest + length_prefix, str, length_string);
+        dest[*length] = 0;
+        return dest;
+    }
+
+    std::size_t string_length(const char *str) FOONATHAN_NOEXCEPT
+    {
+        const void *mem = str - sizeof(std::size_t);
+        return *static_cast<const std::size_t*>(mem);
+    }
+
+    void deallocate_string(const char *str) FOONATHAN_NOEXCEPT
+    {
+        ::operator delete(const_cast<char*>(str - sizeof(std::size_t)));
+    }
+}
+
+/// \cond impl
+struct sid::flat_map_database::slot
+{
+    hash_type hash;
+    const char *str;
+};
+/// \endcond
+
+sid::flat_map_database::flat_map_database(std::size_t size)
+: ctrl_(nullptr), slots_(nullptr), capacity_(0u), no_items_(0u), growth_left_(0u),
+  string_bytes_(0u), no_collisions_(0u), no_rehashes_(0u), rehash_nanoseconds_(0u)
+{
+    auto capacity = ctrl_group::width;
+    while (capacity < size)
+        capacity *= 2;
+    allocate(capacity);
+}
+
+sid::flat_map_database::~flat_map_database() FOONATHAN_NOEXCEPT
+{
+    for (std::size_t i = 0u; i != capacity_; ++i)
+        if (ctrl_[i] >= 0)
+            deallocate_string(slots_[i].str);
+    ::operator delete(slots_);
+    delete[] ctrl_;
+}
+
+sid::basic_database::insert_status sid::flat_map_database::insert(hash_type hash, const char *str, std::size_t length)
+{
+    return insert_impl(hash, "", 0u, str, length);
+}
+
+sid::basic_database::insert_status sid::flat_map_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                         const char *str, std::size_t length)
+{
+    // non-virtual call, thread_safe_database has already locked
+    auto prefix_str = flat_map_database::lookup(prefix);
+    return insert_impl(hash, prefix_str, string_length(prefix_str), str, length);
+}
+
+const char* sid::flat_map_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto i = find_index(hash);
+    assert(i != capacity_ && "hash not inserted");
+    return slots_[i].str;
+}
+
+bool sid::flat_map_database::erase(hash_type hash)
+{
+    auto i = find_index(hash);
+    if (i == capacity_)
+        return false;
+    auto str = slots_[i].str;
+    string_bytes_ -= string_length(str) + 1;
+    deallocate_string(str);
+    // a probe only stops at a group with an empty slot, so the slot can only become empty
+    // if every group containing it has one, otherwise it is marked as deleted and reused by insert
+    auto empty_before = ctrl_group(ctrl_ + ((i - ctrl_group::width) & (capacity_ - 1))).match(ctrl_empty);
+    auto empty_after = ctrl_group(ctrl_ + i).match(ctrl_empty);
+    if (empty_before && empty_after
+        && count_leading_zeros(empty_before) + count_trailing_zeros(empty_after) < ctrl_group::width)
+    {
+        set_ctrl(i, ctrl_empty);
+        ++growth_left_;
+    }
+    else
+        set_ctrl(i, ctrl_deleted);
+    --no_items_;
+    invalidate_caches();
+    return true;
+}
+
+const char* sid::flat_map_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto i = find_index(hash);
+    return i == capacity_ ? nullptr : slots_[i].str;
+}
+
+sid::database_statistics sid::flat_map_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    database_statistics result = database_statistics();
+    result.no_strings = no_items_;
+    result.no_buckets = capacity_;
+    result.string_bytes = string_bytes_;
+    // length header of each string, slots and control bytes
+    result.overhead_bytes = no_items_ * sizeof(std::size_t) + capacity_ * sizeof(slot)
+                          + capacity_ + ctrl_group::width;
+    result.no_collisions = no_collisions_;
+    result.no_rehashes = no_rehashes_;
+    result.rehash_nanoseconds = rehash_nanoseconds_;
+    return result;
+}
+
+std::size_t sid::flat_map_database::find_index(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto mask = capacity_ - 1;
+    auto h2 = ctrl_hash(hash);
+    auto pos = slot_hash(hash) & mask;
+    for (std::size_t step = ctrl_group::width;; step += ctrl_group::width)
+    {
+        ctrl_group group(ctrl_ + pos);
+        for (auto match = group.match(h2); match; match &= match - 1)
+        {
+            auto i = (pos + count_trailing_zeros(match)) & mask;
+            if (slots_[i].hash == hash)
+                return i;
+        }
+        if (group.match(ctrl_empty))
+            return capacity_;
+        pos = (pos + step) & mask;
+    }
+}
+
+std::size_t sid::flat_map_database::find_insert_pos(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto mask = capacity_ - 1;
+    auto pos = slot_hash(hash) & mask;
+    for (std::size_t step = ctrl_group::width;; step += ctrl_group::width)
+    {
+        ctrl_group group(ctrl_ + pos);
+        auto empty = group.match(ctrl_empty) | group.match(ctrl_deleted);
+        if (empty)
+            return (pos + count_trailing_zeros(empty)) & mask;
+        pos = (pos + step) & mask;
+    }
+}
+
+sid::basic_database::insert_status sid::flat_map_database::insert_impl(hash_type hash,
+                                                                       const char *prefix, std::size_t length_prefix,
+                                                                       const char *str, std::size_t length_string)
+{
+    auto i = find_index(hash);
+    if (i != capacity_)
+    {
+        auto other = slots_[i].str;
+        auto equal = string_length(other) == length_prefix + length_string
+                  && std::memcmp(other, prefix, length_prefix) == 0
+                  && std::memcmp(other + length_prefix, str, length_string) == 0;
+        if (equal)
+            return old_string;
+        ++no_collisions_;
+        return collision;
+    }
+
+    if (growth_left_ == 0u)
+        rehash();
+    auto new_str = allocate_string(prefix, length_prefix, str, length_string);
+    string_bytes_ += length_prefix + length_string + 1;
+    i = find_insert_pos(hash);
+    if (ctrl_[i] == ctrl_empty)
+        --growth_left_;
+    set_ctrl(i, ctrl_hash(hash));
+    slots_[i].hash = hash;
+    slots_[i].str = new_str;
+    ++no_items_;
+    return new_string;
+}
+
+void sid::flat_map_database::set_ctrl(std::size_t i, signed char value) FOONATHAN_NOEXCEPT
+{
+    ctrl_[i] = value;
+    // the first group is mirrored after the end, so that a group can be loaded at any position
+    if (i < ctrl_group::width)
+        ctrl_[capacity_ + i] = value;
+}
+
+void sid::flat_map_database::allocate(std::size_t capacity)
+{
+    assert(capacity >= ctrl_group::width && (capacity & (capacity - 1)) == 0u);
+    std::unique_ptr<signed char[]> ctrl(new signed char[capacity + ctrl_group::width]);
+    slots_ = static_cast<slot*>(::operator new(capacity * sizeof(slot)));
+    ctrl_ = ctrl.release();
+    std::memset(ctrl_, ctrl_empty, capacity + ctrl_group::width);
+    capacity_ = capacity;
+    growth_left_ = max_items(capacity) - no_items_;
+}
+
+void sid::flat_map_database::rehash()
+{
+    static FOONATHAN_CONSTEXPR auto growth_factor = 2;
+    timer t(rehash_nanoseconds_);
+    ++no_rehashes_;
+    auto old_ctrl = ctrl_;
+    auto old_slots = slots_;
+    auto old_capacity = capacity_;
+
+    // only removes deleted slots if there are enough of them
+    allocate(no_items_ >= max_items(old_capacity) / 2 ? growth_factor * old_capacity : old_capacity);
+    for (std::size_t i = 0u; i != old_capacity; ++i)
+        if (old_ctrl[i] >= 0)
+        {
+            auto pos = find_insert_pos(old_slots[i].hash);
+            set_ctrl(pos, old_ctrl[i]);
+            slots_[pos] = old_slots[i];
+        }
+
+    ::operator delete(old_slots);
+    delete[] old_ctrl;
+}
+
+/// \cond impl
+struct sid::concurrent_database::entry
+{
+    hash_type hash;
+    std::size_t length;
+
+    entry(hash_type h, const char *prefix, std::size_t length_prefix,
+          const char *str, std::size_t length_string) FOONATHAN_NOEXCEPT
+    : hash(h), length(length_prefix + length_string)
+    {
+        auto dest = const_cast<char*>(get_str());
+        std::memcpy(dest, prefix, length_prefix);
+        std::memcpy(dest + length_prefix, str, length_string);
+        dest[length] = 0;
+    }
+
+    const char* get_str() const FOONATHAN_NOEXCEPT
+    {
+        const void *mem = this;
+        return static_cast<const char*>(mem) + sizeof(entry);
+    }
+};
+
+struct sid::concurrent_database::table
+{
+    std::size_t capacity;
+    table *next_retired;
+
+    std::atomic<const entry*>* slots() FOONATHAN_NOEXCEPT
+    {
+        void *mem = this;
+        return static_cast<std::atomic<const entry*>*>(static_cast<void*>(static_cast<char*>(mem) + sizeof(table)));
+    }
+
+    const std::atomic<const entry*>* slots() const FOONATHAN_NOEXCEPT
+    {
+        return const_cast<table*>(this)->slots();
+    }
+
+    static table* allocate(std::size_t capacity)
+    {
+        auto mem = ::operator new(sizeof(table) + capacity * sizeof(std::atomic<const entry*>));
+        auto t = ::new(mem) table;
+        t->capacity = capacity;
+        t->next_retired = nullptr;
+        for (auto slot = t->slots(); slot != t->slots() + capacity; ++slot)
+            ::new(static_cast<void*>(slot)) std::atomic<const entry*>(nullptr);
+        return t;
+    }
+
+    static void deallocate(table *t) FOONATHAN_NOEXCEPT
+    {
+        ::operator delete(t);
+    }
+};
+/// \endcond
+
+sid::concurrent_database::concurrent_database(std::size_t size)
+: retired_(nullptr), no_items_(0u), string_bytes_(0u), no_collisions_(0u), no_rehashes_(0u), rehash_nanoseconds_(0u)
+{
+    std::size_t capacity = 16u;
+    while (capacity < size)
+        capacity *= 2;
+    table_.store(table::allocate(capacity), std::memory_order_relaxed);
+}
+
+sid::concurrent_database::~concurrent_database() FOONATHAN_NOEXCEPT
+{
+    table::deallocate(table_.load(std::memory_order_relaxed));
+    while (retired_)
+    {
+        auto next = retired_->next_retired;
+        table::deallocate(retired_);
+        retired_ = next;
+    }
+}
+
+sid::basic_database::insert_status sid::concurrent_database::insert(hash_type hash, const char *str, std::size_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insert_impl(hash, "", 0u, str, length);
+}
+
+sid::basic_database::insert_status sid::concurrent_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                           const char *str, std::size_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto prefix_entry = find_entry(prefix);
+    assert(prefix_entry && "prefix not inserted");
+    return insert_impl(hash, prefix_entry->get_str(), prefix_entry->length, str, length);
+}
+
+const char* sid::concurrent_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto e = find_entry(hash);
+    assert(e && "hash not inserted");
+    return e->get_str();
+}
+
+sid::database_statistics sid::concurrent_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    database_statistics result = database_statistics();
+    result.no_strings = no_items_;
+    auto t = table_.load(std::memory_order_relaxed);
+    result.no_buckets = t->capacity;
+    result.string_bytes = string_bytes_;
+    result.overhead_bytes = arena_.bytes_reserved() - result.string_bytes
+                          + sizeof(table) + t->capacity * sizeof(std::atomic<const entry*>);
+    for (auto retired = retired_; retired; retired = retired->next_retired)
+        result.overhead_bytes += sizeof(table) + retired->capacity * sizeof(std::atomic<const entry*>);
+    result.no_collisions = no_collisions_;
+    result.no_rehashes = no_rehashes_;
+    result.rehash_nanoseconds = rehash_nanoseconds_;
+    return result;
+}
+
+const char* sid::concurrent_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto e = find_entry(hash);
+    return e ? e->get_str() : nullptr;
+}
+
+const sid::concurrent_database::entry* sid::concurrent_database::find_entry(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    // any table published after the insertion of the hash contains it
+    auto t = table_.load(std::memory_order_acquire);
+    auto mask = t->capacity - 1;
+    for (auto i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask)
+    {
+        auto e = t->slots()[i].load(std::memory_order_acquire);
+        if (!e || e->hash == hash)
+            return e;
+    }
+}
+
+sid::basic_database::insert_status sid::concurrent_database::insert_impl(hash_type hash,
+                                                                         const char *prefix, std::size_t length_prefix,
+                                                                         const char *str, std::size_t length_string)
+{
+    if (auto e = find_entry(hash))
+    {
+        auto equal = e->length == length_prefix + length_string
+                  && std::memcmp(e->get_str(), prefix, length_prefix) == 0
+                  && std::memcmp(e->get_str() + length_prefix, str, length_string) == 0;
+        if (equal)
+            return old_string;
+        ++no_collisions_;
+        return collision;
+    }
+
+    // maximum load factor of 1/2
+    if (2 * (no_items_ + 1) > table_.load(std::memory_order_relaxed)->capacity)
+        grow();
+
+    auto mem = arena_.allocate(sizeof(entry) + length_prefix + length_string + 1, alignof(entry));
+    auto e = ::new(mem) entry(hash, prefix, length_prefix, str, length_string);
+    string_bytes_ += length_prefix + length_string + 1;
+
+    auto t = table_.load(std::memory_order_relaxed);
+    auto mask = t->capacity - 1;
+    auto i = static_cast<std::size_t>(hash) & mask;
+    while (t->slots()[i].load(std::memory_order_relaxed))
+        i = (i + 1) & mask;
+    // publishes the fully constructed entry
+    t->slots()[i].store(e, std::memory_order_release);
+    ++no_items_;
+    return new_string;
+}
+
+void sid::concurrent_database::grow()
+{
+    static FOONATHAN_CONSTEXPR auto growth_factor = 2;
+    timer t(rehash_nanoseconds_);
+    ++no_rehashes_;
+    auto old_table = table_.load(std::memory_order_relaxed);
+    auto new_table = table::allocate(growth_factor * old_table->capacity);
+    auto mask = new_table->capacity - 1;
+    for (std::size_t i = 0u; i != old_table->capacity; ++i)
+    {
+        auto e = old_table->slots()[i].load(std::memory_order_relaxed);
+        if (!e)
+            continue;
+        auto j = static_cast<std::size_t>(e->hash) & mask;
+        while (new_table->slots()[j].load(std::memory_order_relaxed))
+            j = (j + 1) & mask;
+        new_table->slots()[j].store(e, std::memory_order_relaxed);
+    }
+
+    // readers might still use the old table, so it is only freed in the destructor
+    old_table->next_retired = retired_;
+    retired_ = old_table;
+    table_.store(new_table, std::memory_order_release);
 }
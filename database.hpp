@@ -5,11 +5,20 @@
 #ifndef FOONATHAN_STRING_ID_DATABASE_HPP_INCLUDED
 #define FOONATHAN_STRING_ID_DATABASE_HPP_INCLUDED
 
+#include <atomic>
+#include <climits>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
 
+#include "arena.hpp"
 #include "basic_database.hpp"
 #include "config.hpp"
+#include "instrumentation.hpp"
+#include "spin_lock.hpp"
 
 namespace foonathan { namespace string_id
 {    
@@ -38,64 +47,621 @@ namespace foonathan { namespace string_id
     /// \brief A database that uses a highly optimized hash table.
     class map_database : public basic_database
     {
-    public:        
-        /// \brief Creates a new database with given number of buckets and maximum load factor.
-        explicit map_database(std::size_t size = 1024, double max_load_factor = 1.0);
+    public:
+        /// \brief How the memory for the strings is allocated.
+        enum storage_policy
+        {
+            /// \brief Each string is allocated separately on the heap.
+            heap_storage,
+            /// \brief The strings are placed in big slabs of memory which are freed all at once.
+            /// \detail This avoids the overhead of the individual allocations.
+            arena_storage
+        };
+
+        /// \brief Creates a new database with given number of buckets, maximum load factor and \ref storage_policy.
+        explicit map_database(std::size_t size = 1024, double max_load_factor = 1.0,
+                              storage_policy policy = heap_storage);
         ~map_database() FOONATHAN_NOEXCEPT;
         
         insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
         insert_status insert_prefix(hash_type hash, hash_type prefix,
                                     const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Inserts a string given as segments.
+        /// \detail The segments are copied directly into the new node.
+        insert_status insert_segments(hash_type hash, const string_info *segments,
+                                      std::size_t count) FOONATHAN_OVERRIDE;
+
+        /// \brief Inserts multiple strings at once.
+        /// \detail The bucket array is grown to its final size first
+        /// and the buckets of the following strings are prefetched.
+        void insert_batch(const hash_type *hashes, const string_info *strings,
+                          insert_status *status, std::size_t count) FOONATHAN_OVERRIDE;
+
+        /// \brief Inserts multiple strings with the same prefix at once.
+        /// \detail Same as \ref insert_batch, the strings share the prefix if \ref set_prefix_sharing() is enabled.
+        void insert_prefix_batch(const hash_type *hashes, hash_type prefix, const string_info *strings,
+                                 insert_status *status, std::size_t count) FOONATHAN_OVERRIDE;
+
         const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Removes a string.
+        /// \detail With \ref heap_storage its memory is freed immediately,
+        /// with \ref arena_storage only when the database is destroyed.<br>
+        /// If other strings share it as prefix, they get their own copy of it first.
+        /// Finding them requires visiting all strings,
+        /// so erasing a shared prefix takes time linear in the size of the database,
+        /// a \ref thread_safe_database holds its lock meanwhile.
+        /// Otherwise it only searches the bucket of the string.
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Calls a function for each stored string.
+        /// \detail It is called with the hash, the null-terminated string and its length in an unspecified order.
+        void for_each(const std::function<void(hash_type, const char*, std::size_t)> &f) const;
+
+        /// \brief Enables or disables sharing the prefix of strings inserted via \c insert_prefix().
+        /// \detail By default, the prefix is copied into the memory of each string.<br>
+        /// If it is enabled, a new string only stores a pointer to the string of its prefix and the suffix.
+        /// This saves memory if the prefix is longer than two pointers,
+        /// e.g. for identifiers created by a generator.
+        /// The whole string is only created when it is requested by \c lookup() or \ref for_each(),
+        /// use \ref for_each_segment() to access it without.<br>
+        /// It only affects strings inserted afterwards.
+        void set_prefix_sharing(bool share) FOONATHAN_NOEXCEPT
+        {
+            share_prefixes_ = share;
+        }
+
+        /// \brief Returns whether or not prefixes are shared.
+        bool prefix_sharing() const FOONATHAN_NOEXCEPT
+        {
+            return share_prefixes_;
+        }
+
+        /// \brief Calls a function for each part of the string stored with a given hash.
+        /// \detail It is called with a string and its length, which is not null-terminated, in order.
+        /// Strings not sharing a prefix consist of one part only.
+        void for_each_segment(hash_type hash, const std::function<void(const char*, std::size_t)> &f) const;
+
+        /// \brief Returns the number of bytes allocated for storing the strings.
+        /// \detail For \ref arena_storage this is the total size of all slabs.
+        std::size_t bytes_reserved() const FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns the number of bytes actually used for storing the strings.
+        std::size_t bytes_used() const FOONATHAN_NOEXCEPT;
+
+        /// \brief Enables or disables incremental rehashing.
+        /// \detail By default, all strings are moved into the bigger bucket array at once
+        /// by the insertion that exceeds the maximum load factor.<br>
+        /// If incremental rehashing is enabled, both bucket arrays are kept and each following insertion
+        /// only migrates \c buckets_per_insert old buckets, this bounds the latency of a single insertion.
+        /// If the next rehash is necessary before the migration has finished, it is finished immediately,
+        /// this does not happen if \c buckets_per_insert is at least the inverse of the maximum load factor.<br>
+        /// A value of \c 0 disables it.
+        void set_incremental_rehash(std::size_t buckets_per_insert) FOONATHAN_NOEXCEPT;
+
+        /// \brief Migrates all remaining buckets of an incremental rehash.
+        void finish_rehash() FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns whether or not there is an incremental rehash in progress.
+        bool is_rehashing() const FOONATHAN_NOEXCEPT
+        {
+            return bool(old_buckets_);
+        }
+
+        /// \brief Returns the fraction of old buckets already migrated by the current incremental rehash.
+        /// \detail It is \c 1.0 if there is none.
+        double rehash_progress() const FOONATHAN_NOEXCEPT;
         
     private:        
-        void rehash();
-        
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
         class node_list;
-        std::unique_ptr<node_list[]> buckets_;
+
+        node_list& get_bucket(hash_type hash) const FOONATHAN_NOEXCEPT;
+        void prepare_insert();
+        void reserve(std::size_t no_items);
+        void rehash(std::size_t new_size);
+        void migrate(std::size_t no_buckets) FOONATHAN_NOEXCEPT;
+        void* allocate_node(std::size_t size);
+        void inserted(const node_list &bucket, insert_status status) FOONATHAN_NOEXCEPT;
+        void chain_length_changed(std::size_t old_length, std::size_t new_length) FOONATHAN_NOEXCEPT;
+        
+        std::unique_ptr<node_list[]> buckets_, old_buckets_;
         std::size_t no_items_, no_buckets_;
         double max_load_factor_;
         std::size_t next_resize_;
+        std::size_t no_old_buckets_, next_migration_, rehash_step_;
+        detail::memory_arena arena_;
+        std::size_t bytes_used_;
+        storage_policy policy_;
+        bool share_prefixes_;
+        std::size_t no_shared_nodes_;
+        std::size_t chain_lengths_[database_statistics::histogram_size];
+        std::size_t string_bytes_, no_collisions_, no_rehashes_;
+        std::uint64_t rehash_nanoseconds_;
     };
-    
+
+    /// \brief A database that uses an open addressing hash table.
+    /// \detail The hashes are stored in one contiguous table whose size is a power of two.
+    /// Each slot has a control byte storing a few bits of the hash,
+    /// whole groups of them are compared at once using SSE2/AVX2 if available.<br>
+    /// Compared to \ref map_database lookups do not need to follow any pointers except to the string itself.
+    class flat_map_database : public basic_database
+    {
+    public:
+        /// \brief Creates a new database with given number of slots.
+        /// \detail The number will be rounded up to the next power of two.
+        explicit flat_map_database(std::size_t size = 1024);
+        ~flat_map_database() FOONATHAN_NOEXCEPT;
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Removes a string and frees its memory.
+        /// \detail Its slot is marked as deleted and reused by later insertions.
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+    private:
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
+        struct slot;
+
+        std::size_t find_index(hash_type hash) const FOONATHAN_NOEXCEPT;
+        std::size_t find_insert_pos(hash_type hash) const FOONATHAN_NOEXCEPT;
+        insert_status insert_impl(hash_type hash,
+                                  const char *prefix, std::size_t length_prefix,
+                                  const char *str, std::size_t length_string);
+        void set_ctrl(std::size_t i, signed char value) FOONATHAN_NOEXCEPT;
+        void allocate(std::size_t capacity);
+        void rehash();
+
+        signed char *ctrl_;
+        slot *slots_;
+        std::size_t capacity_, no_items_, growth_left_;
+        std::size_t string_bytes_, no_collisions_, no_rehashes_;
+        std::uint64_t rehash_nanoseconds_;
+    };
+
+    /// \brief A thread-safe database where lookups never block.
+    /// \detail Writers are synchronized via \c std::mutex,
+    /// but \c lookup() does not take any lock and only performs atomic loads.<br>
+    /// The strings are stored in immutable entries that are never moved.
+    /// The hash table only stores pointers to them and is replaced completely when growing,
+    /// old tables are kept until the database is destroyed, so concurrent readers can still use them.
+    class concurrent_database : public basic_database
+    {
+    public:
+        /// \brief Creates a new database with given number of slots.
+        /// \detail The number will be rounded up to the next power of two.
+        explicit concurrent_database(std::size_t size = 1024);
+        ~concurrent_database() FOONATHAN_NOEXCEPT;
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash or \c nullptr if there is none.
+        /// \detail Like \c lookup() it does not take any lock.
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the statistics.
+        /// \detail Unlike \c lookup() it locks the mutex of the writers.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+    private:
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
+        struct entry;
+        struct table;
+
+        const entry* find_entry(hash_type hash) const FOONATHAN_NOEXCEPT;
+        insert_status insert_impl(hash_type hash,
+                                  const char *prefix, std::size_t length_prefix,
+                                  const char *str, std::size_t length_string);
+        void grow();
+
+        std::atomic<table*> table_;
+        table *retired_;
+        std::size_t no_items_, string_bytes_, no_collisions_, no_rehashes_;
+        std::uint64_t rehash_nanoseconds_;
+        detail::memory_arena arena_;
+        mutable std::mutex mutex_;
+    };
+
+    namespace detail
+    {
+        // whether or not Database overrides basic_database::insert_batch()
+        template <class Database>
+        struct has_insert_batch
+        : std::integral_constant<bool, !std::is_same<decltype(&Database::insert_batch),
+                                                     decltype(&basic_database::insert_batch)>::value>
+        {};
+
+        // whether or not Database overrides basic_database::insert_prefix_batch()
+        template <class Database>
+        struct has_insert_prefix_batch
+        : std::integral_constant<bool, !std::is_same<decltype(&Database::insert_prefix_batch),
+                                                     decltype(&basic_database::insert_prefix_batch)>::value>
+        {};
+
+        // whether or not Database overrides basic_database::insert_segments()
+        template <class Database>
+        struct has_insert_segments
+        : std::integral_constant<bool, !std::is_same<decltype(&Database::insert_segments),
+                                                     decltype(&basic_database::insert_segments)>::value>
+        {};
+
+        // returns the concatenation of all segments
+        std::string concatenate(const string_info *segments, std::size_t count);
+    } // namespace detail
+
     /// \brief A thread-safe database adapter.
-    /// \detail It derives from any database type and synchronizes access via \c std::mutex.
-    template <class Database>
+    /// \detail It derives from any database type and synchronizes access via \c Mutex.
+    /// It must provide \c lock(), \c try_lock() and \c unlock(), e.g. \c std::mutex, \ref spin_lock or \ref ticket_lock.
+    /// If it provides \c lock_shared() and \c unlock_shared() as well, e.g. \ref shared_spin_lock,
+    /// \c lookup() and \c find() only take it shared,
+    /// which requires that they can be called concurrently on \c Database,
+    /// this is the case for all databases of this library.<br>
+    /// If \ref FOONATHAN_STRING_ID_INSTRUMENTATION is \c true, it records statistics about the lock,
+    /// see \ref lock_statistics.
+    template <class Database, class Mutex = std::mutex>
     class thread_safe_database : public Database
     {
     public:
         /// \brief The base database.
         typedef Database base_database;
+
+        /// \brief The type of the lock.
+        typedef Mutex mutex_type;
         
         // workaround of lacking inheriting constructors
 		template <typename ... Args>
         explicit thread_safe_database(Args&&... args)
-		: base_database(std::forward<Args>(args)...) {}
+		: base_database(std::forward<Args>(args)...), instrumentation_(*this) {}
         
         typename Database::insert_status
             insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::insert_operation);
             return Database::insert(hash, str, length);
         }
         
         typename Database::insert_status
             insert_prefix(hash_type hash, hash_type prefix, const char *str, std::size_t length) FOONATHAN_OVERRIDE
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::insert_prefix_operation);
             return Database::insert_prefix(hash, prefix, str, length);
         }
         
+        void insert_batch(const hash_type *hashes, const string_info *strings,
+                          typename Database::insert_status *status, std::size_t count) FOONATHAN_OVERRIDE
+        {
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::other_operation);
+            insert_batch_impl(detail::has_insert_batch<Database>(), hashes, strings, status, count);
+        }
+
+        void insert_prefix_batch(const hash_type *hashes, hash_type prefix, const string_info *strings,
+                                 typename Database::insert_status *status, std::size_t count) FOONATHAN_OVERRIDE
+        {
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::other_operation);
+            insert_prefix_batch_impl(detail::has_insert_prefix_batch<Database>(),
+                                     hashes, prefix, strings, status, count);
+        }
+        
+        typename Database::insert_status
+            insert_segments(hash_type hash, const string_info *segments, std::size_t count) FOONATHAN_OVERRIDE
+        {
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::insert_operation);
+            return insert_segments_impl(detail::has_insert_segments<Database>(), hash, segments, count);
+        }
+        
         const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
         {
-            std::lock_guard<std::mutex> lock(mutex_);
+            detail::read_lock_guard<Mutex> lock(mutex_, instrumentation_, detail::lookup_operation);
             return Database::lookup(hash);
         }
+
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE
+        {
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::other_operation);
+            return Database::erase(hash);
+        }
+
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            detail::read_lock_guard<Mutex> lock(mutex_, instrumentation_, detail::lookup_operation);
+            return Database::find(hash);
+        }
+        
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            detail::lock_guard<Mutex> lock(mutex_, instrumentation_, detail::other_operation);
+            return Database::statistics();
+        }
+        
+    #if FOONATHAN_STRING_ID_INSTRUMENTATION
+        /// \brief Returns a snapshot of the lock statistics recorded so far.
+        /// \detail It is only available if \ref FOONATHAN_STRING_ID_INSTRUMENTATION is \c true.
+        lock_statistics instrumentation() const
+        {
+            std::lock_guard<Mutex> lock(mutex_);
+            return instrumentation_.statistics();
+        }
+    #endif
+
+        /// \brief Calls the \ref lock_statistics_handler with the lock statistics recorded so far.
+        /// \detail The handler isn't called on destruction,
+        /// call it before to report the acquisitions since the last periodic call.<br>
+        /// It does nothing if \ref FOONATHAN_STRING_ID_INSTRUMENTATION is \c false.
+        void flush_lock_statistics() const
+        {
+        #if FOONATHAN_STRING_ID_INSTRUMENTATION
+            instrumentation_.call_handler(instrumentation());
+        #endif
+        }
         
     private:
-        mutable std::mutex mutex_;
+        void insert_batch_impl(std::true_type, const hash_type *hashes, const string_info *strings,
+                               typename Database::insert_status *status, std::size_t count)
+        {
+            Database::insert_batch(hashes, strings, status, count);
+        }
+
+        // the default implementation would call the virtual insert() and lock again
+        void insert_batch_impl(std::false_type, const hash_type *hashes, const string_info *strings,
+                               typename Database::insert_status *status, std::size_t count)
+        {
+            for (std::size_t i = 0u; i != count; ++i)
+                status[i] = Database::insert(hashes[i], strings[i].string, strings[i].length);
+        }
+
+        void insert_prefix_batch_impl(std::true_type, const hash_type *hashes, hash_type prefix,
+                                      const string_info *strings, typename Database::insert_status *status,
+                                      std::size_t count)
+        {
+            Database::insert_prefix_batch(hashes, prefix, strings, status, count);
+        }
+
+        // the default implementation would call the virtual insert_prefix() and lock again
+        void insert_prefix_batch_impl(std::false_type, const hash_type *hashes, hash_type prefix,
+                                      const string_info *strings, typename Database::insert_status *status,
+                                      std::size_t count)
+        {
+            for (std::size_t i = 0u; i != count; ++i)
+                status[i] = Database::insert_prefix(hashes[i], prefix, strings[i].string, strings[i].length);
+        }
+
+        typename Database::insert_status
+            insert_segments_impl(std::true_type, hash_type hash, const string_info *segments, std::size_t count)
+        {
+            return Database::insert_segments(hash, segments, count);
+        }
+
+        // the default implementation would call the virtual insert() and lock again
+        typename Database::insert_status
+            insert_segments_impl(std::false_type, hash_type hash, const string_info *segments, std::size_t count)
+        {
+            auto str = detail::concatenate(segments, count);
+            return Database::insert(hash, str.c_str(), str.size());
+        }
+
+        mutable Mutex mutex_;
+        mutable detail::lock_instrumentation instrumentation_;
     };
     
+    namespace detail
+    {
+        template <std::size_t N>
+        struct log2
+        {
+            static FOONATHAN_CONSTEXPR std::size_t value = 1u + log2<N / 2>::value;
+        };
+
+        template <>
+        struct log2<1u>
+        {
+            static FOONATHAN_CONSTEXPR std::size_t value = 0u;
+        };
+    } // namespace detail
+
+    /// \brief A thread-safe database that distributes the strings over multiple databases.
+    /// \detail Each hash is routed to one of \c NoShards databases of type \c Database using its high bits.
+    /// Each of them is synchronized via its own \c std::mutex,
+    /// so operations on different shards do not block each other.<br>
+    /// \c NoShards must be a power of two.
+    template <class Database, std::size_t NoShards = 16>
+    class sharded_database : public basic_database
+    {
+        static_assert(NoShards != 0u && (NoShards & (NoShards - 1)) == 0u,
+                      "number of shards must be a power of two");
+    public:
+        /// \brief The type of the databases of each shard.
+        typedef Database base_database;
+
+        /// \brief Returns the number of shards.
+        static FOONATHAN_CONSTEXPR_FNC std::size_t no_shards() FOONATHAN_NOEXCEPT
+        {
+            return NoShards;
+        }
+
+        /// \brief Creates the databases of all shards by passing them the given arguments.
+        template <typename ... Args>
+        explicit sharded_database(const Args&... args)
+        : cacheable_(true)
+        {
+            std::size_t i = 0u;
+            try
+            {
+                for (; i != NoShards; ++i)
+                    ::new(static_cast<void*>(&storage_[i])) shard(args...);
+            }
+            catch (...)
+            {
+                while (i--)
+                    get_shard(i).~shard();
+                throw;
+            }
+            // cache_id() is 0 if the shard isn't cacheable
+            for (i = 0u; i != NoShards; ++i)
+                cacheable_ = cacheable_ && get_shard(i).db.cache_id() != 0u;
+        }
+
+        ~sharded_database() FOONATHAN_NOEXCEPT
+        {
+            for (std::size_t i = 0u; i != NoShards; ++i)
+                get_shard(i).~shard();
+        }
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.db.insert(hash, str, length);
+        }
+
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            auto &prefix_shard = get_shard(shard_index(prefix));
+            if (&s == &prefix_shard)
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                return s.db.insert_prefix(hash, prefix, str, length);
+            }
+
+            // the prefix string stays valid, so the lock of its shard can be released immediately
+            const char *prefix_str;
+            {
+                std::lock_guard<std::mutex> lock(prefix_shard.mutex);
+                prefix_str = prefix_shard.db.lookup(prefix);
+            }
+            std::string full(prefix_str);
+            full.append(str, length);
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.db.insert(hash, full.c_str(), full.size());
+        }
+
+        insert_status insert_segments(hash_type hash, const string_info *segments,
+                                      std::size_t count) FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.db.insert_segments(hash, segments, count);
+        }
+
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.db.lookup(hash);
+        }
+
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (!s.db.erase(hash))
+                return false;
+            // the intern cache stores this database, not the shard
+            invalidate_caches();
+            return true;
+        }
+
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            auto &s = get_shard(shard_index(hash));
+            std::lock_guard<std::mutex> lock(s.mutex);
+            return s.db.find(hash);
+        }
+
+        /// \brief Returns the sum of the statistics of all shards.
+        /// \detail The shards are locked one after the other,
+        /// so the result isn't a consistent snapshot under concurrent insertions.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            database_statistics result = database_statistics();
+            for (std::size_t i = 0u; i != NoShards; ++i)
+            {
+                auto &s = get_shard(i);
+                database_statistics cur;
+                {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    cur = s.db.statistics();
+                }
+                result.no_strings += cur.no_strings;
+                result.no_buckets += cur.no_buckets;
+                for (std::size_t j = 0u; j != database_statistics::histogram_size; ++j)
+                    result.chain_length[j] += cur.chain_length[j];
+                result.string_bytes += cur.string_bytes;
+                result.overhead_bytes += cur.overhead_bytes;
+                result.no_collisions += cur.no_collisions;
+                result.no_rehashes += cur.no_rehashes;
+                result.rehash_nanoseconds += cur.rehash_nanoseconds;
+            }
+            return result;
+        }
+
+    private:
+        // only if the shards are, e.g. a shard forwarding to another database might not be
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return cacheable_;
+        }
+
+        struct shard
+        {
+            Database db;
+            mutable std::mutex mutex;
+            char padding[64]; // avoid false sharing between the mutexes
+
+            template <typename ... Args>
+            explicit shard(const Args&... args)
+            : db(args...) {}
+        };
+
+        static std::size_t shard_index(hash_type hash) FOONATHAN_NOEXCEPT
+        {
+            // shift in two steps, so that it is well-defined for a single shard
+            static FOONATHAN_CONSTEXPR auto shift = sizeof(hash_type) * CHAR_BIT - 1u - detail::log2<NoShards>::value;
+            return static_cast<std::size_t>((hash >> shift) >> 1u);
+        }
+
+        shard& get_shard(std::size_t i) FOONATHAN_NOEXCEPT
+        {
+            return *static_cast<shard*>(static_cast<void*>(&storage_[i]));
+        }
+
+        const shard& get_shard(std::size_t i) const FOONATHAN_NOEXCEPT
+        {
+            return *static_cast<const shard*>(static_cast<const void*>(&storage_[i]));
+        }
+
+        typename std::aligned_storage<sizeof(shard), alignof(shard)>::type storage_[NoShards];
+        bool cacheable_;
+    };
+
     /// \brief The default database where the strings are stored.
     /// \detail Its exact type is one of the previous listed databases.
     /// You can control its selection via the macros listed in config.hpp.in.
@@ -91,3 +91,12 @@ catch (...)
 {
     return "foonathan::string_id::generation_error: unable to generate new string id.";
 }
+
+const char* sid::snapshot_error::what() const FOONATHAN_NOEXCEPT try
+{
+    return what_.c_str();
+}
+catch (...)
+{
+    return "foonathan::string_id::snapshot_error: unable to read or write snapshot file.";
+}
@@ -111,6 +111,31 @@ namespace foonathan { namespace string_id
     private:
         std::string name_, what_;
     };
+    
+    /// \brief The exception class thrown when reading or writing a snapshot file fails.
+    class snapshot_error : public error
+    {
+    public:
+        //=== constructor/destructor ===//
+        /// \brief Creates it by giving it the path of the file and a description of the problem.
+        snapshot_error(const char *path, const char *reason)
+        : path_(path), what_("foonathan::string_id::snapshot_error: Snapshot file \"" + path_ +
+                             "\": " + reason) {}
+        
+        ~snapshot_error() FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE {}
+        
+        //=== accessors ===//
+        const char* what() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+        
+        /// \brief Returns the path of the snapshot file.
+        const char* path() const FOONATHAN_NOEXCEPT
+        {
+            return path_.c_str();
+        }
+        
+    private:
+        std::string path_, what_;
+    };
 }} // namespace foonathan::string_id
 
 #endif // FOONATHAN_STRING_ID_ERROR_HPP_INCLUDED
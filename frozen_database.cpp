@@ -0,0 +1,215 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "frozen_database.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // finalizer of MurmurHash3, distributes the bits of the FNV-1a hash
+    std::uint64_t mix(std::uint64_t x) FOONATHAN_NOEXCEPT
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // maps x to [0, n) without a division
+    std::size_t reduce(std::uint32_t x, std::size_t n) FOONATHAN_NOEXCEPT
+    {
+        return static_cast<std::size_t>((std::uint64_t(x) * n) >> 32);
+    }
+
+    std::size_t get_bucket(std::uint64_t h, std::size_t no_buckets) FOONATHAN_NOEXCEPT
+    {
+        return reduce(static_cast<std::uint32_t>(h >> 32), no_buckets);
+    }
+
+    std::size_t get_slot(std::uint64_t h, std::uint32_t displacement, std::size_t no_slots) FOONATHAN_NOEXCEPT
+    {
+        return reduce(static_cast<std::uint32_t>(mix(h ^ (displacement * 0x9e3779b97f4a7c15ull))), no_slots);
+    }
+
+    struct key
+    {
+        sid::hash_type hash;
+        const char *str;
+        std::size_t length;
+        std::uint64_t h;
+        std::size_t bucket;
+    };
+
+    // searches a displacement for each bucket so that all keys are mapped to different slots
+    // returns false if it wasn't possible for the given seed
+    bool build_displacements(std::vector<key> &keys, std::vector<std::uint32_t> &displacements,
+                             std::vector<std::size_t> &positions, std::uint64_t seed)
+    {
+        auto no_keys = keys.size();
+        auto no_buckets = displacements.size();
+        for (auto &k : keys)
+        {
+            k.h = mix(k.hash ^ seed);
+            k.bucket = get_bucket(k.h, no_buckets);
+        }
+        // biggest buckets first, they are hardest to place
+        std::vector<std::size_t> bucket_size(no_buckets);
+        for (auto &k : keys)
+            ++bucket_size[k.bucket];
+        std::sort(keys.begin(), keys.end(), [&](const key &a, const key &b)
+                  {
+                      return bucket_size[a.bucket] != bucket_size[b.bucket] ?
+                             bucket_size[a.bucket] > bucket_size[b.bucket] : a.bucket < b.bucket;
+                  });
+
+        auto max_tries = std::max<std::uint64_t>(1u << 16, 32u * no_keys);
+        std::vector<bool> taken(no_keys);
+        for (std::size_t begin = 0u; begin != no_keys;)
+        {
+            auto end = begin + bucket_size[keys[begin].bucket];
+            std::uint64_t d = 0u;
+            for (; d != max_tries; ++d)
+            {
+                auto i = begin;
+                for (; i != end; ++i)
+                {
+                    positions[i] = get_slot(keys[i].h, static_cast<std::uint32_t>(d), no_keys);
+                    if (taken[positions[i]]
+                        || std::find(&positions[begin], &positions[i], positions[i]) != &positions[i])
+                        break;
+                }
+                if (i == end)
+                    break;
+            }
+            if (d == max_tries)
+                return false;
+
+            displacements[keys[begin].bucket] = static_cast<std::uint32_t>(d);
+            for (auto i = begin; i != end; ++i)
+                taken[positions[i]] = true;
+            begin = end;
+        }
+        return true;
+    }
+}
+
+sid::frozen_database::frozen_database(const map_database &db, basic_database *fallback)
+: seed_(0u), fallback_(fallback)
+{
+    std::vector<key> keys;
+    db.for_each([&](hash_type hash, const char *str, std::size_t length)
+                {
+                    keys.push_back({hash, str, length, 0u, 0u});
+                });
+    if (keys.size() >= std::size_t(1u) << 31)
+        throw std::length_error("foonathan::string_id::frozen_database: too many strings");
+
+    // on average four keys per bucket
+    displacements_.resize(keys.size() / 4 + 1);
+    std::vector<std::size_t> positions(keys.size());
+    while (!build_displacements(keys, displacements_, positions, seed_))
+        ++seed_;
+
+    slots_.resize(keys.size());
+    for (std::size_t i = 0u; i != keys.size(); ++i)
+        slots_[positions[i]] = {keys[i].hash, i, keys[i].length};
+
+    // pack the strings in table order
+    std::size_t total_length = 0u;
+    for (auto &k : keys)
+        total_length += k.length + 1;
+    strings_.reserve(total_length);
+    for (auto &s : slots_)
+    {
+        auto &k = keys[s.offset];
+        s.offset = strings_.size();
+        strings_.insert(strings_.end(), k.str, k.str + k.length);
+        strings_.push_back(0);
+    }
+}
+
+sid::basic_database::insert_status sid::frozen_database::insert(hash_type hash, const char *str, std::size_t length)
+{
+    if (auto s = find_slot(hash))
+        return s->length == length && std::memcmp(&strings_[s->offset], str, length) == 0 ?
+               old_string : collision;
+    return fallback_ ? fallback_->insert(hash, str, length) : collision;
+}
+
+sid::basic_database::insert_status sid::frozen_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                       const char *str, std::size_t length)
+{
+    auto prefix_slot = find_slot(prefix);
+    auto s = find_slot(hash);
+    if (s)
+    {
+        // non-virtual call, thread_safe_database has already locked
+        auto prefix_str = frozen_database::lookup(prefix);
+        auto prefix_length = prefix_slot ? prefix_slot->length : std::strlen(prefix_str);
+        auto stored = &strings_[s->offset];
+        return s->length == prefix_length + length
+            && std::memcmp(stored, prefix_str, prefix_length) == 0
+            && std::memcmp(stored + prefix_length, str, length) == 0 ?
+               old_string : collision;
+    }
+    else if (!fallback_)
+        return collision;
+    else if (!prefix_slot)
+        // prefix is stored in the fallback as well
+        return fallback_->insert_prefix(hash, prefix, str, length);
+
+    std::string full(&strings_[prefix_slot->offset], prefix_slot->length);
+    full.append(str, length);
+    return fallback_->insert(hash, full.c_str(), full.size());
+}
+
+const char* sid::frozen_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (auto s = find_slot(hash))
+        return &strings_[s->offset];
+    return fallback_ ? fallback_->lookup(hash) : "string_id frozen database: string not stored";
+}
+
+const char* sid::frozen_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (auto s = find_slot(hash))
+        return &strings_[s->offset];
+    return fallback_ ? fallback_->find(hash) : nullptr;
+}
+
+sid::database_statistics sid::frozen_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    database_statistics result = database_statistics();
+    result.no_strings = slots_.size();
+    result.no_buckets = slots_.size();
+    result.string_bytes = strings_.size();
+    result.overhead_bytes = displacements_.capacity() * sizeof(std::uint32_t)
+                          + slots_.capacity() * sizeof(slot)
+                          + strings_.capacity() - strings_.size();
+    return result;
+}
+
+std::size_t sid::frozen_database::position(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto h = mix(hash ^ seed_);
+    auto bucket = get_bucket(h, displacements_.size());
+    return get_slot(h, displacements_[bucket], slots_.size());
+}
+
+const sid::frozen_database::slot* sid::frozen_database::find_slot(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    if (slots_.empty())
+        return nullptr;
+    auto &s = slots_[position(hash)];
+    return s.hash == hash ? &s : nullptr;
+}
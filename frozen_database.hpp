@@ -0,0 +1,89 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_FROZEN_DATABASE_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_FROZEN_DATABASE_HPP_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief An immutable database using a minimal perfect hash function.
+    /// \detail It is built from all strings currently stored in a \ref map_database
+    /// and is meant for phases where no new strings are created.<br>
+    /// The strings are stored contiguously in the order of the table,
+    /// a lookup only needs to read the displacement of the bucket and then the slot itself.<br>
+    /// Inserting a string that is not stored is forwarded to a fallback database.
+    /// If there is none, the insertion fails with \c collision, so the \ref collision_handler will be called.<br>
+    /// Since it is never modified, accessing it from multiple threads is safe
+    /// as long as the fallback database is thread safe as well.
+    class frozen_database : public basic_database
+    {
+    public:
+        /// \brief Builds the database from all strings stored in \c db.
+        /// \detail \c fallback, if not \c nullptr, stores all strings inserted later
+        /// and must stay valid as long as this database.
+        explicit frozen_database(const map_database &db, basic_database *fallback = nullptr);
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash.
+        /// \detail If it isn't stored here, it is looked up in the fallback database.
+        /// If there is none, it returns an error message.
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash or \c nullptr if there is none.
+        /// \detail If it isn't stored here, the fallback database is searched.
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the statistics of the perfect hash table.
+        /// \detail The fallback database is not included.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the number of strings stored in the perfect hash table.
+        std::size_t size() const FOONATHAN_NOEXCEPT
+        {
+            return slots_.size();
+        }
+
+        /// \brief Returns the fallback database, may be \c nullptr.
+        basic_database* fallback() const FOONATHAN_NOEXCEPT
+        {
+            return fallback_;
+        }
+
+    private:
+        // the fallback can erase strings without invalidating the caches of this database
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return !fallback_;
+        }
+
+        struct slot
+        {
+            hash_type hash;
+            std::size_t offset, length;
+        };
+
+        std::size_t position(hash_type hash) const FOONATHAN_NOEXCEPT;
+
+        // returns nullptr if the hash isn't stored
+        const slot* find_slot(hash_type hash) const FOONATHAN_NOEXCEPT;
+
+        std::vector<std::uint32_t> displacements_;
+        std::vector<slot> slots_;
+        std::vector<char> strings_;
+        std::uint64_t seed_;
+        basic_database *fallback_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_FROZEN_DATABASE_HPP_INCLUDED
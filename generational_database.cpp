@@ -0,0 +1,108 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "generational_database.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+namespace sid = foonathan::string_id;
+
+sid::generational_database::generational_database(std::size_t size)
+: size_(size)
+{
+    begin_generation();
+}
+
+sid::basic_database::insert_status sid::generational_database::insert(hash_type hash, const char *str,
+                                                                       std::size_t length)
+{
+    if (auto stored = find_older(hash))
+        return std::strlen(stored) == length && std::memcmp(stored, str, length) == 0 ?
+               old_string : collision;
+    return generations_.back()->insert(hash, str, length);
+}
+
+sid::basic_database::insert_status sid::generational_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                             const char *str, std::size_t length)
+{
+    if (!find_older(hash) && generations_.back()->find(prefix))
+        return generations_.back()->insert_prefix(hash, prefix, str, length);
+
+    // non-virtual call, thread_safe_database has already locked
+    auto prefix_str = generational_database::find(prefix);
+    assert(prefix_str && "prefix not inserted or expired");
+    std::string full(prefix_str);
+    full.append(str, length);
+    return generational_database::insert(hash, full.c_str(), full.size());
+}
+
+const char* sid::generational_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto str = generational_database::find(hash);
+    return str ? str : "string_id generational database: string expired";
+}
+
+bool sid::generational_database::erase(hash_type hash)
+{
+    for (auto iter = generations_.rbegin(); iter != generations_.rend(); ++iter)
+        if ((*iter)->erase(hash))
+        {
+            // the intern cache stores this database, not the generation
+            invalidate_caches();
+            return true;
+        }
+    return false;
+}
+
+sid::database_statistics sid::generational_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    database_statistics result = database_statistics();
+    for (auto &generation : generations_)
+    {
+        auto cur = generation->statistics();
+        result.no_strings += cur.no_strings;
+        result.no_buckets += cur.no_buckets;
+        for (std::size_t j = 0u; j != database_statistics::histogram_size; ++j)
+            result.chain_length[j] += cur.chain_length[j];
+        result.string_bytes += cur.string_bytes;
+        result.overhead_bytes += cur.overhead_bytes;
+        result.no_collisions += cur.no_collisions;
+        result.no_rehashes += cur.no_rehashes;
+        result.rehash_nanoseconds += cur.rehash_nanoseconds;
+    }
+    return result;
+}
+
+void sid::generational_database::begin_generation()
+{
+    std::unique_ptr<map_database> generation(new map_database(size_, 1.0, map_database::arena_storage));
+    generations_.push_back(std::move(generation));
+}
+
+bool sid::generational_database::end_generation() FOONATHAN_NOEXCEPT
+{
+    if (generations_.size() == 1u)
+        return false;
+    generations_.pop_back();
+    invalidate_caches();
+    return true;
+}
+
+const char* sid::generational_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    for (auto iter = generations_.rbegin(); iter != generations_.rend(); ++iter)
+        if (auto str = (*iter)->find(hash))
+            return str;
+    return nullptr;
+}
+
+const char* sid::generational_database::find_older(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    for (auto iter = generations_.begin(); iter != generations_.end() - 1; ++iter)
+        if (auto str = (*iter)->find(hash))
+            return str;
+    return nullptr;
+}
@@ -0,0 +1,109 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_GENERATIONAL_DATABASE_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_GENERATIONAL_DATABASE_HPP_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief A database whose strings are grouped into generations that can be dropped at once.
+    /// \detail The generations form a stack, the first one exists as long as the database.
+    /// New strings are stored in the newest generation unless an older one already stores them.<br>
+    /// Each generation is a \ref map_database using \c arena_storage,
+    /// so ending one frees all its strings with a few deallocations, independent of their number.
+    /// The ids of those strings are expired afterwards, \c lookup() returns an error message for them
+    /// and \ref expired() can be used to check for it.<br>
+    /// It is not thread safe, wrap it in a \ref thread_safe_database for that,
+    /// but \ref begin_generation() and \ref end_generation() must still not be called concurrently with other operations.
+    class generational_database : public basic_database
+    {
+    public:
+        /// \brief Begins a generation in its constructor and ends it in the destructor.
+        class scope
+        {
+        public:
+            explicit scope(generational_database &db)
+            : db_(db)
+            {
+                db_.begin_generation();
+            }
+
+            ~scope() FOONATHAN_NOEXCEPT
+            {
+                db_.end_generation();
+            }
+
+            scope(const scope &) = delete;
+            scope& operator=(const scope &) = delete;
+
+        private:
+            generational_database &db_;
+        };
+
+        /// \brief Creates a database with the first generation.
+        /// \detail \c size is the initial number of buckets of the \ref map_database of each generation.
+        explicit generational_database(std::size_t size = 1024);
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash.
+        /// \detail If its generation has ended, it returns an error message.
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Removes a string from the generation storing it.
+        /// \detail Its memory is only freed when the generation ends.
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash or \c nullptr if there is none.
+        /// \detail This is the case for strings whose generation has ended.
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the sum of the statistics of all generations.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Begins a new generation.
+        void begin_generation();
+
+        /// \brief Ends the newest generation and frees all strings stored in it.
+        /// \detail The first generation can't be ended, then it does nothing.
+        /// \return \c true if a generation was ended, \c false if only the first one is left.
+        bool end_generation() FOONATHAN_NOEXCEPT;
+
+        /// \brief Returns the number of generations, including the first one.
+        std::size_t no_generations() const FOONATHAN_NOEXCEPT
+        {
+            return generations_.size();
+        }
+
+        /// \brief Returns whether or not a string isn't stored in any generation.
+        /// \detail This is the case for the ids of strings whose generation has ended or that were erased.
+        bool expired(hash_type hash) const FOONATHAN_NOEXCEPT
+        {
+            return !find(hash);
+        }
+
+    private:
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
+        // only searches the generations before the newest one
+        const char* find_older(hash_type hash) const FOONATHAN_NOEXCEPT;
+
+        std::vector<std::unique_ptr<map_database>> generations_;
+        std::size_t size_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_GENERATIONAL_DATABASE_HPP_INCLUDED
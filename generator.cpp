@@ -17,20 +17,39 @@ bool sid::detail::handle_generation_error(std::size_t counter, const char *name,
     return get_generation_error_handler()(counter, name, result.hash_code(), result.string());
 }
 
+std::uint64_t sid::detail::next_generator_id() FOONATHAN_NOEXCEPT
+{
+    static std::atomic<std::uint64_t> next_id(1u);
+    return next_id.fetch_add(1u, std::memory_order_relaxed);
+}
+
 namespace
-{    
+{
+    // the two digits of all numbers from 0 to 99
+    FOONATHAN_CONSTEXPR char digit_pairs[]
+    = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+
     sid::string_info to_string(sid::counter_generator::state s, char *begin, char *end,
                                std::size_t length)
     {
         auto cur = end;
-        std::size_t i = 0;
-        
-        do
+        for (; s >= 100u; s /= 100u)
+        {
+            auto i = static_cast<std::size_t>(s % 100u) * 2;
+            *--cur = digit_pairs[i + 1];
+            *--cur = digit_pairs[i];
+        }
+        if (s >= 10u)
         {
-            *--cur = '0' + (s % 10);
-            s /= 10;
-            ++i;
-        } while (s != 0u);
+            auto i = static_cast<std::size_t>(s) * 2;
+            *--cur = digit_pairs[i + 1];
+            *--cur = digit_pairs[i];
+        }
+        else
+            *--cur = static_cast<char>('0' + s);
+        std::size_t i = end - cur;
         
         if (i < length)
             for (; cur - 1 != begin && i < length; ++i)
@@ -40,12 +59,13 @@ namespace
             
         return sid::string_info(cur, end - cur);
     }
+
+    // 4 times sizeof(state) is enough for the integer representation
+    FOONATHAN_CONSTEXPR auto max_size = 4 * sizeof(sid::counter_generator::state);
 }
 
 sid::string_id sid::counter_generator::operator()()
 {
-    // 4 times sizeof(state) is enough for the integer representation
-    static FOONATHAN_CONSTEXPR auto max_size = 4 * sizeof(state);
     char string[max_size];
     return detail::try_generate("foonathan::string_id::counter_generator",
                                 [&]()
@@ -54,6 +74,26 @@ sid::string_id sid::counter_generator::operator()()
                                 }, prefix_);
 }
 
+std::vector<sid::string_id> sid::counter_generator::generate_batch(std::size_t n)
+{
+    auto first = counter_.fetch_add(n);
+    std::vector<char> buffer(n * max_size);
+    std::vector<string_info> suffixes;
+    suffixes.reserve(n);
+    for (std::size_t i = 0u; i != n; ++i)
+    {
+        auto begin = &buffer[i * max_size];
+        suffixes.push_back(to_string(first + i, begin, begin + max_size, length_));
+    }
+
+    char string[max_size];
+    return detail::try_generate_batch("foonathan::string_id::counter_generator",
+                                      [&]()
+                                      {
+                                          return to_string(counter_++, string, string + max_size, length_);
+                                      }, prefix_, suffixes);
+}
+
 void sid::counter_generator::discard(unsigned long long n) FOONATHAN_NOEXCEPT
 {
     counter_ += n;
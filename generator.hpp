@@ -5,8 +5,15 @@
 #ifndef FOONATHAN_STRING_ID_GENERATOR_HPP_INCLUDED
 #define FOONATHAN_STRING_ID_GENERATOR_HPP_INCLUDED
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <thread>
+#include <vector>
 
 #include "config.hpp"
 #include "string_id.hpp"
@@ -16,6 +23,9 @@ namespace foonathan { namespace string_id
     namespace detail
     {
         bool handle_generation_error(std::size_t counter, const char *name, const string_id &result);
+
+        // returns a new id that is unique among all generators, never 0
+        std::uint64_t next_generator_id() FOONATHAN_NOEXCEPT;
         
         template <typename Generator>
         string_id try_generate(const char *name, Generator generator, const string_id &prefix)
@@ -29,6 +39,23 @@ namespace foonathan { namespace string_id
                 result = string_id(prefix, generator(), status);
             return result;
         }
+
+        // inserts all generated suffixes at once,
+        // each one that wasn't new is replaced using the generator in the same way as try_generate()
+        template <typename Generator>
+        std::vector<string_id> try_generate_batch(const char *name, Generator generator, const string_id &prefix,
+                                                  const std::vector<string_info> &suffixes)
+        {
+            std::vector<basic_database::insert_status> status(suffixes.size());
+            auto result = make_string_ids(prefix, suffixes.data(), suffixes.size(), status.data());
+            for (std::size_t i = 0u; i != result.size(); ++i)
+                for (std::size_t counter = 1;
+                     status[i] != basic_database::new_string &&
+                     handle_generation_error(counter, name, result[i]);
+                     ++counter)
+                    result[i] = string_id(prefix, generator(), status[i]);
+            return result;
+        }
     }
     
     /// \brief A generator that generates string ids with a prefix followed by a number.
@@ -53,11 +80,25 @@ namespace foonathan { namespace string_id
         /// \brief Generates a new \ref string_id.
         /// \detail If it was already generated previously, the \ref generator_error_handler will be called in a loop as described there.
         string_id operator()();
+
+        /// \brief Generates \c n new \ref string_id objects and writes them to \c out.
+        /// \detail It reserves \c n consecutive counter values at once
+        /// and inserts all strings with a single call to \ref basic_database::insert_prefix_batch.<br>
+        /// If one was already generated previously, it is replaced like in the single version.
+        /// \return The iterator after the last id written.
+        template <typename OutputIt>
+        OutputIt generate(std::size_t n, OutputIt out)
+        {
+            auto ids = generate_batch(n);
+            return std::copy(ids.begin(), ids.end(), out);
+        }
         
         /// \brief Discards a number of states by advancing the counter.
         void discard(unsigned long long n) FOONATHAN_NOEXCEPT;
         
     private:
+        std::vector<string_id> generate_batch(std::size_t n);
+
         string_id prefix_;
         std::atomic<state> counter_;
         std::size_t length_;
@@ -120,6 +161,37 @@ namespace foonathan { namespace string_id
                         return string_info(random, Length);
                     }, prefix_);
         }
+
+        /// \brief Generates \c n new \ref string_id objects and writes them to \c out.
+        /// \detail It inserts all strings with a single call to \ref basic_database::insert_prefix_batch.<br>
+        /// If one was already generated previously, it is replaced like in the single version.
+        /// \return The iterator after the last id written.
+        template <typename OutputIt>
+        OutputIt generate(std::size_t n, OutputIt out)
+        {
+            std::uniform_int_distribution<std::size_t>
+                dist(0, table_.no_characters - 1);
+            std::vector<char> buffer(n * Length);
+            std::vector<string_info> suffixes;
+            suffixes.reserve(n);
+            for (std::size_t i = 0u; i != n; ++i)
+            {
+                auto random = &buffer[i * Length];
+                for (std::size_t j = 0u; j != Length; ++j)
+                    random[j] = table_.characters[dist(state_)];
+                suffixes.push_back(string_info(random, Length));
+            }
+
+            char random[Length];
+            auto ids = detail::try_generate_batch("foonathan::string_id::random_generator",
+                    [&]()
+                    {
+                        for (std::size_t i = 0u; i != Length; ++i)
+                            random[i] = table_.characters[dist(state_)];
+                        return string_info(random, Length);
+                    }, prefix_, suffixes);
+            return std::copy(ids.begin(), ids.end(), out);
+        }
         
         /// \brief Discards a certain number of states, this forwards to the random number generator.
         void discard(unsigned long long n)
@@ -132,6 +204,140 @@ namespace foonathan { namespace string_id
         state state_;
         character_table table_;
     };
+
+    /// \brief A generator that generates string ids by appendending random characters to a prefix
+    /// and can be used by multiple threads at the same time.
+    /// \detail Unlike \ref random_generator it does not share one random number generator.
+    /// Each thread gets its own one, the first time it uses the generator,
+    /// which is seeded with a \c std::seed_seq consisting of the master seed and the number of the stream.
+    /// Apart from that, the threads do not need to be synchronized.<br>
+    /// The sequence of each stream is deterministic for a given seed,
+    /// but which thread gets which stream depends on the order they first use the generator.<br>
+    /// The database of the prefix must be thread safe.
+    /// The random number generator must be constructible from a \c std::seed_seq.
+    template <class RandomNumberGenerator, std::size_t Length>
+    class concurrent_random_generator
+    {
+    public:
+        /// \brief The type of the random number generator of each thread.
+        typedef RandomNumberGenerator state;
+
+        /// \brief The number of characters appended.
+        static FOONATHAN_CONSTEXPR_FNC std::size_t length() FOONATHAN_NOEXCEPT
+        {
+            return Length;
+        }
+
+        /// \brief Creates a new generator with given prefix, master seed and character table.
+        /// \detail By default is uses the table \ref character_table::alnum().
+        explicit concurrent_random_generator(const string_id &prefix, std::uint64_t seed = 0u,
+                                             character_table table = character_table::alnum())
+        : prefix_(prefix), table_(table), seed_(seed), id_(detail::next_generator_id()) {}
+
+        concurrent_random_generator(const concurrent_random_generator &) = delete;
+        concurrent_random_generator& operator=(const concurrent_random_generator &) = delete;
+
+        /// \brief Generates a new \ref string_id using the random number generator of the calling thread.
+        /// \detail If it was already generated previously, the \ref generator_error_handler will be called in a loop as described there.
+        string_id operator()()
+        {
+            auto &s = get_state();
+            std::uniform_int_distribution<std::size_t>
+                dist(0, table_.no_characters - 1);
+            char random[Length];
+            return detail::try_generate("foonathan::string_id::concurrent_random_generator",
+                    [&]()
+                    {
+                        for (std::size_t i = 0u; i != Length; ++i)
+                            random[i] = table_.characters[dist(s)];
+                        return string_info(random, Length);
+                    }, prefix_);
+        }
+
+        /// \brief Generates \c n new \ref string_id objects and writes them to \c out.
+        /// \detail Same as \ref random_generator::generate() but using the random number generator of the calling thread.
+        template <typename OutputIt>
+        OutputIt generate(std::size_t n, OutputIt out)
+        {
+            auto &s = get_state();
+            std::uniform_int_distribution<std::size_t>
+                dist(0, table_.no_characters - 1);
+            std::vector<char> buffer(n * Length);
+            std::vector<string_info> suffixes;
+            suffixes.reserve(n);
+            for (std::size_t i = 0u; i != n; ++i)
+            {
+                auto random = &buffer[i * Length];
+                for (std::size_t j = 0u; j != Length; ++j)
+                    random[j] = table_.characters[dist(s)];
+                suffixes.push_back(string_info(random, Length));
+            }
+
+            char random[Length];
+            auto ids = detail::try_generate_batch("foonathan::string_id::concurrent_random_generator",
+                    [&]()
+                    {
+                        for (std::size_t i = 0u; i != Length; ++i)
+                            random[i] = table_.characters[dist(s)];
+                        return string_info(random, Length);
+                    }, prefix_, suffixes);
+            return std::copy(ids.begin(), ids.end(), out);
+        }
+
+        /// \brief Returns the number of threads that have used the generator so far.
+        std::size_t no_streams() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return states_.size();
+        }
+
+    private:
+        // returns the random number generator of the calling thread, creates it if necessary
+        state& get_state()
+        {
+        #if FOONATHAN_IMPL_HAS_THREAD_LOCAL
+            // avoids locking for the last generators used by this thread
+            // the ids are never reused, so entries of destroyed generators never match
+            struct cache_entry
+            {
+                std::uint64_t id;
+                state *s;
+            };
+            static FOONATHAN_CONSTEXPR std::size_t cache_size = 8u;
+            static thread_local cache_entry cache[cache_size];
+
+            auto &entry = cache[id_ & (cache_size - 1)];
+            if (entry.id != id_)
+            {
+                entry.s = &create_state();
+                entry.id = id_;
+            }
+            return *entry.s;
+        #else
+            return create_state();
+        #endif
+        }
+
+        state& create_state()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &s = states_[std::this_thread::get_id()];
+            if (!s)
+            {
+                auto stream = static_cast<std::uint32_t>(states_.size() - 1);
+                std::seed_seq seq{static_cast<std::uint32_t>(seed_), static_cast<std::uint32_t>(seed_ >> 32), stream};
+                s.reset(new state(seq));
+            }
+            return *s;
+        }
+
+        string_id prefix_;
+        character_table table_;
+        std::uint64_t seed_, id_;
+        mutable std::mutex mutex_;
+        // the stream of a thread continues if it reuses the generator after an entry of the cache was replaced
+        std::map<std::thread::id, std::unique_ptr<state>> states_;
+    };
 }} // namespace foonathan::string_id
 
 #endif // FOONATHAN_STRING_ID_GENERATOR_HPP_INCLUDED
@@ -5,6 +5,7 @@
 #ifndef FOONATHAN_STRING_ID_HASH_HPP_INCLUDED
 #define FOONATHAN_STRING_ID_HASH_HPP_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
 
 #include "config.hpp"
@@ -12,18 +13,47 @@
 namespace foonathan { namespace string_id
 {
     /// \brief The type of a hashed string.
-    /// \detail This is an unsigned integral type.
+    /// \detail This is an unsigned integral type with \ref FOONATHAN_STRING_ID_HASH_WIDTH bits.
+#if FOONATHAN_STRING_ID_HASH_WIDTH == 32
+    typedef std::uint32_t hash_type;
+#elif FOONATHAN_STRING_ID_HASH_WIDTH == 64
     typedef std::uint64_t hash_type;
+#else
+    #error "FOONATHAN_STRING_ID_HASH_WIDTH must be 32 or 64"
+#endif
     
     namespace detail
     {
+    #if FOONATHAN_STRING_ID_HASH_WIDTH == 32
+        FOONATHAN_CONSTEXPR hash_type fnv_basis = 2166136261u;
+        FOONATHAN_CONSTEXPR hash_type fnv_prime = 16777619u;
+    #else
         FOONATHAN_CONSTEXPR hash_type fnv_basis = 14695981039346656037ull;
         FOONATHAN_CONSTEXPR hash_type fnv_prime = 1099511628211ull;
+    #endif
         
-        // FNV-1a 64 bit hash
+        // FNV-1a hash with the width of hash_type
         FOONATHAN_CONSTEXPR_FNC hash_type sid_hash(const char *str, hash_type hash = fnv_basis)
         {
-            return *str ? sid_hash(str + 1, (hash ^ *str) * fnv_prime) : hash;
+            return *str ? sid_hash(str + 1, static_cast<hash_type>((hash ^ *str) * fnv_prime)) : hash;
+        }
+
+        // same as sid_hash() but uses the given length instead of a null-terminator
+        // iterative version for runtime use
+        inline hash_type sid_hash_n(const char *str, std::size_t length,
+                                    hash_type hash = fnv_basis) FOONATHAN_NOEXCEPT
+        {
+            auto end = str + length;
+            for (; end - str >= 4; str += 4)
+            {
+                hash = (hash ^ str[0]) * fnv_prime;
+                hash = (hash ^ str[1]) * fnv_prime;
+                hash = (hash ^ str[2]) * fnv_prime;
+                hash = (hash ^ str[3]) * fnv_prime;
+            }
+            for (; str != end; ++str)
+                hash = (hash ^ *str) * fnv_prime;
+            return hash;
         }
     } // namespace detail
 }} // foonathan::string_id
@@ -0,0 +1,88 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "instrumentation.hpp"
+
+#include <atomic>
+
+namespace sid = foonathan::string_id;
+
+FOONATHAN_CONSTEXPR std::size_t sid::latency_histogram::size;
+
+namespace
+{
+    void default_lock_statistics_handler(const sid::basic_database &, const sid::lock_statistics &) {}
+
+#if FOONATHAN_STRING_ID_ATOMIC_HANDLER
+    std::atomic<sid::lock_statistics_handler> lock_statistics_h(default_lock_statistics_handler);
+#else
+    sid::lock_statistics_handler lock_statistics_h(default_lock_statistics_handler);
+#endif
+}
+
+sid::lock_statistics_handler sid::set_lock_statistics_handler(lock_statistics_handler h)
+{
+#if FOONATHAN_STRING_ID_ATOMIC_HANDLER
+    return lock_statistics_h.exchange(h);
+#else
+    auto val = lock_statistics_h;
+    lock_statistics_h = h;
+    return val;
+#endif
+}
+
+sid::lock_statistics_handler sid::get_lock_statistics_handler()
+{
+    return lock_statistics_h;
+}
+
+#if FOONATHAN_STRING_ID_INSTRUMENTATION
+namespace
+{
+    void record(sid::latency_histogram &histogram, std::uint64_t nanoseconds) FOONATHAN_NOEXCEPT
+    {
+        std::size_t i = 0u;
+        for (auto value = nanoseconds; value > 1u && i != sid::latency_histogram::size - 1; value >>= 1)
+            ++i;
+        ++histogram.count[i];
+        ++histogram.no_operations;
+        histogram.total_nanoseconds += nanoseconds;
+    }
+}
+
+sid::detail::lock_instrumentation::lock_instrumentation(const basic_database &db) FOONATHAN_NOEXCEPT
+: stats_(), db_(&db) {}
+
+bool sid::detail::lock_instrumentation::acquired(bool contended, std::uint64_t wait_nanoseconds) FOONATHAN_NOEXCEPT
+{
+    ++(contended ? stats_.no_contended : stats_.no_uncontended);
+    stats_.wait_nanoseconds += wait_nanoseconds;
+    return (stats_.no_contended + stats_.no_uncontended) % lock_statistics_interval == 0u;
+}
+
+void sid::detail::lock_instrumentation::released(lock_operation op, std::uint64_t hold_nanoseconds,
+                                                 std::uint64_t latency_nanoseconds) FOONATHAN_NOEXCEPT
+{
+    stats_.hold_nanoseconds += hold_nanoseconds;
+    switch (op)
+    {
+    case insert_operation:
+        record(stats_.insert, latency_nanoseconds);
+        break;
+    case insert_prefix_operation:
+        record(stats_.insert_prefix, latency_nanoseconds);
+        break;
+    case lookup_operation:
+        record(stats_.lookup, latency_nanoseconds);
+        break;
+    case other_operation:
+        break;
+    }
+}
+
+void sid::detail::lock_instrumentation::call_handler(const lock_statistics &stats) const
+{
+    get_lock_statistics_handler()(*db_, stats);
+}
+#endif
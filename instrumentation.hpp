@@ -0,0 +1,233 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_INSTRUMENTATION_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_INSTRUMENTATION_HPP_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+
+namespace foonathan { namespace string_id
+{
+    class basic_database;
+
+    /// \brief A histogram of the latencies of an operation.
+    struct latency_histogram
+    {
+        /// \brief The number of entries in \ref count.
+        static FOONATHAN_CONSTEXPR std::size_t size = 32u;
+
+        /// \brief The number of operations whose latency in nanoseconds has a given binary logarithm.
+        /// \detail Entry \c i counts latencies in <tt>[2^i, 2^(i+1))</tt>, the first one includes \c 0,
+        /// the last one all greater latencies.
+        std::uint64_t count[size];
+        /// \brief The number of operations.
+        std::uint64_t no_operations;
+        /// \brief The sum of all latencies in nanoseconds.
+        std::uint64_t total_nanoseconds;
+    };
+
+    /// \brief The data recorded by an instrumented \ref thread_safe_database.
+    /// \detail The latency of an operation includes the time waiting for the lock.
+    /// If the lock is a reader/writer lock, the shared acquisitions by \c lookup() and \c find() are not recorded.
+    struct lock_statistics
+    {
+        /// @{
+        /// \brief The latencies of each operation.
+        latency_histogram insert, insert_prefix, lookup;
+        /// @}
+
+        /// \brief The total time spent waiting for the lock in nanoseconds.
+        std::uint64_t wait_nanoseconds;
+        /// \brief The total time the lock has been held in nanoseconds.
+        std::uint64_t hold_nanoseconds;
+        /// \brief The number of acquisitions where the lock was held by another thread.
+        std::uint64_t no_contended;
+        /// \brief The number of acquisitions where the lock was free.
+        std::uint64_t no_uncontended;
+    };
+
+    /// \brief The type of the lock statistics handler.
+    /// \detail It will be called by an instrumented \ref thread_safe_database
+    /// after every \ref lock_statistics_interval acquisitions of its lock and by \c flush_lock_statistics(),
+    /// giving it the database and a copy of its current statistics.
+    /// It is called without the lock held, so it can access the database.
+    /// It is not called on destruction, the database can't be accessed anymore then.<br>
+    /// The default handler does nothing.
+    typedef void(*lock_statistics_handler)(const basic_database &db, const lock_statistics &stats);
+
+    /// \brief The number of lock acquisitions between two calls to the \ref lock_statistics_handler.
+    FOONATHAN_CONSTEXPR std::uint64_t lock_statistics_interval = 64 * 1024u;
+
+    /// \brief Exchanges the \ref lock_statistics_handler.
+    /// \detail This function is thread safe if \ref FOONATHAN_STRING_ID_ATOMIC_HANDLER is \c true.
+    lock_statistics_handler set_lock_statistics_handler(lock_statistics_handler h);
+
+    /// \brief Returns the current \ref lock_statistics_handler.
+    lock_statistics_handler get_lock_statistics_handler();
+
+    namespace detail
+    {
+        enum lock_operation
+        {
+            insert_operation,
+            insert_prefix_operation,
+            lookup_operation,
+            other_operation // not part of any histogram
+        };
+
+    #if FOONATHAN_STRING_ID_INSTRUMENTATION
+        // records the statistics of one lock
+        // all members must only be accessed with the lock held
+        class lock_instrumentation
+        {
+        public:
+            explicit lock_instrumentation(const basic_database &db) FOONATHAN_NOEXCEPT;
+
+            lock_instrumentation(const lock_instrumentation &) = delete;
+            lock_instrumentation& operator=(const lock_instrumentation &) = delete;
+
+            // returns true if the handler should be called
+            bool acquired(bool contended, std::uint64_t wait_nanoseconds) FOONATHAN_NOEXCEPT;
+
+            void released(lock_operation op, std::uint64_t hold_nanoseconds,
+                          std::uint64_t latency_nanoseconds) FOONATHAN_NOEXCEPT;
+
+            const lock_statistics& statistics() const FOONATHAN_NOEXCEPT
+            {
+                return stats_;
+            }
+
+            // must be called without the lock held
+            void call_handler(const lock_statistics &stats) const;
+
+        private:
+            lock_statistics stats_;
+            const basic_database *db_;
+        };
+
+        // lock guard that records the statistics of each acquisition
+        template <class Mutex>
+        class lock_guard
+        {
+        public:
+            lock_guard(Mutex &mutex, lock_instrumentation &instrumentation, lock_operation op)
+            : mutex_(mutex), instrumentation_(instrumentation), op_(op),
+              start_(clock::now()), report_(false)
+            {
+                auto contended = !mutex_.try_lock();
+                if (contended)
+                    mutex_.lock();
+                acquired_ = clock::now();
+                report_ = instrumentation_.acquired(contended, nanoseconds(start_, acquired_));
+            }
+
+            lock_guard(const lock_guard &) = delete;
+            lock_guard& operator=(const lock_guard &) = delete;
+
+            ~lock_guard() FOONATHAN_NOEXCEPT
+            {
+                auto end = clock::now();
+                instrumentation_.released(op_, nanoseconds(acquired_, end), nanoseconds(start_, end));
+                if (!report_)
+                {
+                    mutex_.unlock();
+                    return;
+                }
+
+                auto stats = instrumentation_.statistics();
+                mutex_.unlock();
+                try
+                {
+                    instrumentation_.call_handler(stats);
+                }
+                catch (...) {} // must not leave the destructor
+            }
+
+        private:
+            typedef std::chrono::steady_clock clock;
+
+            static std::uint64_t nanoseconds(clock::time_point begin, clock::time_point end) FOONATHAN_NOEXCEPT
+            {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            }
+
+            Mutex &mutex_;
+            lock_instrumentation &instrumentation_;
+            lock_operation op_;
+            clock::time_point start_, acquired_;
+            bool report_;
+        };
+    #else
+        // instrumentation is disabled, nothing is recorded
+        class lock_instrumentation
+        {
+        public:
+            explicit lock_instrumentation(const basic_database &) FOONATHAN_NOEXCEPT {}
+
+            lock_instrumentation(const lock_instrumentation &) = delete;
+            lock_instrumentation& operator=(const lock_instrumentation &) = delete;
+        };
+
+        template <class Mutex>
+        class lock_guard : public std::lock_guard<Mutex>
+        {
+        public:
+            lock_guard(Mutex &mutex, lock_instrumentation &, lock_operation)
+            : std::lock_guard<Mutex>(mutex) {}
+        };
+    #endif
+
+        template <class Mutex>
+        auto has_lock_shared_impl(int) -> decltype(std::declval<Mutex&>().lock_shared(), std::true_type());
+
+        template <class Mutex>
+        std::false_type has_lock_shared_impl(...);
+
+        // whether or not Mutex is a reader/writer lock
+        template <class Mutex>
+        struct has_lock_shared : decltype(has_lock_shared_impl<Mutex>(0))
+        {};
+
+        // lock guard for operations that do not modify the database
+        // it takes a reader/writer lock shared, this is not recorded
+        template <class Mutex, bool Shared = has_lock_shared<Mutex>::value>
+        class read_lock_guard : public lock_guard<Mutex>
+        {
+        public:
+            read_lock_guard(Mutex &mutex, lock_instrumentation &instrumentation, lock_operation op)
+            : lock_guard<Mutex>(mutex, instrumentation, op) {}
+        };
+
+        template <class Mutex>
+        class read_lock_guard<Mutex, true>
+        {
+        public:
+            read_lock_guard(Mutex &mutex, lock_instrumentation &, lock_operation)
+            : mutex_(mutex)
+            {
+                mutex_.lock_shared();
+            }
+
+            read_lock_guard(const read_lock_guard &) = delete;
+            read_lock_guard& operator=(const read_lock_guard &) = delete;
+
+            ~read_lock_guard() FOONATHAN_NOEXCEPT
+            {
+                mutex_.unlock_shared();
+            }
+
+        private:
+            Mutex &mutex_;
+        };
+    } // namespace detail
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_INSTRUMENTATION_HPP_INCLUDED
@@ -0,0 +1,73 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "overlay_database.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+namespace sid = foonathan::string_id;
+
+sid::overlay_database::overlay_database(const basic_database &parent, std::size_t size)
+: parent_(parent), local_(size, 1.0, map_database::arena_storage) {}
+
+sid::basic_database::insert_status sid::overlay_database::insert(hash_type hash, const char *str,
+                                                                 std::size_t length)
+{
+    if (auto stored = parent_.find(hash))
+        return std::strlen(stored) == length && std::memcmp(stored, str, length) == 0 ?
+               old_string : collision;
+    return local_.insert(hash, str, length);
+}
+
+sid::basic_database::insert_status sid::overlay_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                        const char *str, std::size_t length)
+{
+    auto stored = parent_.find(hash);
+    if (!stored && local_.find(prefix))
+        return local_.insert_prefix(hash, prefix, str, length);
+
+    // non-virtual call, thread_safe_database has already locked
+    auto prefix_str = overlay_database::find(prefix);
+    assert(prefix_str && "prefix not inserted");
+    if (stored)
+    {
+        auto prefix_length = std::strlen(prefix_str);
+        return std::strlen(stored) == prefix_length + length
+            && std::memcmp(stored, prefix_str, prefix_length) == 0
+            && std::memcmp(stored + prefix_length, str, length) == 0 ?
+               old_string : collision;
+    }
+
+    std::string full(prefix_str);
+    full.append(str, length);
+    return local_.insert(hash, full.c_str(), full.size());
+}
+
+const char* sid::overlay_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto str = local_.find(hash);
+    return str ? str : parent_.lookup(hash);
+}
+
+const char* sid::overlay_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto str = local_.find(hash);
+    return str ? str : parent_.find(hash);
+}
+
+bool sid::overlay_database::erase(hash_type hash)
+{
+    if (!local_.erase(hash))
+        return false;
+    // the intern cache stores this database, not the local one
+    invalidate_caches();
+    return true;
+}
+
+sid::database_statistics sid::overlay_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    return local_.statistics();
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_OVERLAY_DATABASE_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_OVERLAY_DATABASE_HPP_INCLUDED
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief Tag type to create an \ref overlay_database on top of another overlay.
+    struct stack_on_t {};
+
+    /// \brief Tag to create an \ref overlay_database on top of another overlay.
+    FOONATHAN_CONSTEXPR stack_on_t stack_on = stack_on_t();
+
+    /// \brief A database that adds strings to a parent database without modifying it.
+    /// \detail Insertions check whether the parent stores the string via its \c find() function,
+    /// only new strings are stored in a small local \ref map_database using \c arena_storage.
+    /// The parent is never modified, so no lock of it is taken for writing,
+    /// and destroying the overlay frees all of its strings at once.<br>
+    /// The parent must stay valid as long as the overlay
+    /// and must implement \c find(), otherwise all strings are stored locally.
+    /// Overlays can be stacked, e.g. a global vocabulary, an overlay per level and one per request.<br>
+    /// The overlay itself is not thread safe, but any number of overlays can share the same parent
+    /// if it is thread safe itself.
+    class overlay_database : public basic_database
+    {
+    public:
+        /// \brief Creates an empty overlay of a parent database.
+        /// \detail \c size is the initial number of buckets of the local database.
+        explicit overlay_database(const basic_database &parent, std::size_t size = 64);
+
+        /// \brief Creates an empty overlay of another overlay, e.g. \c overlay_database(stack_on, parent).
+        /// \detail It is the same as the other constructor,
+        /// the tag is needed because an overlay can't be copied.
+        overlay_database(stack_on_t, const overlay_database &parent, std::size_t size = 64)
+        : overlay_database(static_cast<const basic_database&>(parent), size) {}
+
+        overlay_database(const overlay_database &) = delete;
+        overlay_database(overlay_database &&) = delete;
+        overlay_database& operator=(const overlay_database &) = delete;
+        overlay_database& operator=(overlay_database &&) = delete;
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash.
+        /// \detail The local database is searched first, then the parent.
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the string stored with a given hash or \c nullptr if there is none.
+        /// \detail The local database is searched first, then the parent.
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Removes a string stored in the local database.
+        /// \detail Strings of the parent can't be removed.
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the statistics of the local database.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the parent database.
+        const basic_database& parent() const FOONATHAN_NOEXCEPT
+        {
+            return parent_;
+        }
+
+        /// \brief Returns the database storing the strings that are not stored in the parent.
+        const map_database& local() const FOONATHAN_NOEXCEPT
+        {
+            return local_;
+        }
+
+    private:
+        // the parent can erase strings without invalidating the caches of the overlay
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return false;
+        }
+
+        const basic_database &parent_;
+        map_database local_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_OVERLAY_DATABASE_HPP_INCLUDED
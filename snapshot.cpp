@@ -0,0 +1,313 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "snapshot.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "error.hpp"
+
+namespace sid = foonathan::string_id;
+
+/// \cond impl
+struct sid::snapshot_database::entry
+{
+    std::uint64_t hash;
+    std::uint64_t offset; // into the strings, empty_offset if the entry is empty
+};
+/// \endcond
+
+namespace
+{
+    struct snapshot_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t hash_size;
+        std::uint64_t no_strings;
+        std::uint64_t table_size; // number of entries, a power of two
+        std::uint64_t strings_size; // size of all strings including null-terminators
+    };
+
+    FOONATHAN_CONSTEXPR char snapshot_magic[8] = "sidsnap";
+    FOONATHAN_CONSTEXPR std::uint32_t snapshot_version = 1u;
+    FOONATHAN_CONSTEXPR std::uint64_t empty_offset = ~std::uint64_t(0u);
+
+    typedef sid::snapshot_database::insert_status insert_status;
+
+    insert_status compare(const char *stored, const char *prefix, std::size_t length_prefix,
+                          const char *str, std::size_t length) FOONATHAN_NOEXCEPT
+    {
+        return std::strncmp(stored, prefix, length_prefix) == 0
+            && std::strncmp(stored + length_prefix, str, length) == 0
+            && stored[length_prefix + length] == 0 ?
+               sid::basic_database::old_string : sid::basic_database::collision;
+    }
+
+    template <typename Entry>
+    class snapshot_writer
+    {
+    public:
+        void add(sid::hash_type hash, const char *str, std::size_t length)
+        {
+            entries_.push_back(Entry{hash, strings_.size()});
+            strings_.insert(strings_.end(), str, str + length);
+            strings_.push_back(0);
+        }
+
+        void write(const char *path) const
+        {
+            // maximum load factor of 1/2
+            std::size_t table_size = 16u;
+            while (table_size < 2 * entries_.size())
+                table_size *= 2;
+            std::vector<Entry> table(table_size, Entry{0u, empty_offset});
+            for (auto &e : entries_)
+            {
+                auto i = static_cast<std::size_t>(e.hash) & (table_size - 1);
+                while (table[i].offset != empty_offset)
+                    i = (i + 1) & (table_size - 1);
+                table[i] = e;
+            }
+
+            snapshot_header header;
+            std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+            header.version = snapshot_version;
+            header.hash_size = sizeof(sid::hash_type);
+            header.no_strings = entries_.size();
+            header.table_size = table_size;
+            header.strings_size = strings_.size();
+
+            auto file = std::fopen(path, "wb");
+            if (!file)
+                throw sid::snapshot_error(path, "unable to open file for writing");
+            auto ok = std::fwrite(&header, sizeof(header), 1u, file) == 1u
+                   && std::fwrite(table.data(), sizeof(Entry), table.size(), file) == table.size()
+                   && std::fwrite(strings_.data(), 1u, strings_.size(), file) == strings_.size();
+            ok = std::fclose(file) == 0 && ok;
+            if (!ok)
+                throw sid::snapshot_error(path, "unable to write file");
+        }
+
+    private:
+        std::vector<Entry> entries_;
+        std::vector<char> strings_;
+    };
+
+    // maps the whole file read-only, returns the size
+    void* map_file(const char *path, std::size_t &size)
+    {
+    #if defined(_WIN32)
+        auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw sid::snapshot_error(path, "unable to open file");
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            throw sid::snapshot_error(path, "not a snapshot file");
+        }
+        size = static_cast<std::size_t>(file_size.QuadPart);
+        auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            throw sid::snapshot_error(path, "unable to map file");
+        // the view keeps the mapping alive
+        auto mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!mem)
+            throw sid::snapshot_error(path, "unable to map file");
+        return mem;
+    #else
+        auto fd = ::open(path, O_RDONLY);
+        if (fd == -1)
+            throw sid::snapshot_error(path, "unable to open file");
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0)
+        {
+            ::close(fd);
+            throw sid::snapshot_error(path, "not a snapshot file");
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        // the mapping stays valid after the file is closed
+        auto mem = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+            throw sid::snapshot_error(path, "unable to map file");
+        return mem;
+    #endif
+    }
+
+    void unmap_file(void *mem, std::size_t size) FOONATHAN_NOEXCEPT
+    {
+    #if defined(_WIN32)
+        (void)size;
+        UnmapViewOfFile(mem);
+    #else
+        ::munmap(mem, size);
+    #endif
+    }
+}
+
+void sid::save_snapshot(const map_database &db, const char *path)
+{
+    snapshot_writer<snapshot_database::entry> writer;
+    db.for_each([&](hash_type hash, const char *str, std::size_t length)
+                {
+                    writer.add(hash, str, length);
+                });
+    writer.write(path);
+}
+
+void sid::save_snapshot(const snapshot_database &db, const char *path)
+{
+    snapshot_writer<snapshot_database::entry> writer;
+    for (std::size_t i = 0u; i <= db.table_mask_; ++i)
+    {
+        auto &e = db.table_[i];
+        if (e.offset != empty_offset)
+        {
+            auto str = db.strings_ + e.offset;
+            writer.add(static_cast<hash_type>(e.hash), str, std::strlen(str));
+        }
+    }
+    db.overlay_.for_each([&](hash_type hash, const char *str, std::size_t length)
+                         {
+                             writer.add(hash, str, length);
+                         });
+    writer.write(path);
+}
+
+sid::snapshot_database::snapshot_database(const char *path, std::size_t size, double max_load_factor)
+: mapping_(nullptr), mapping_size_(0u),
+  table_(nullptr), table_mask_(0u), no_strings_(0u), strings_(nullptr),
+  overlay_(size, max_load_factor)
+{
+    mapping_ = map_file(path, mapping_size_);
+
+    // validate the header and the sizes of table and strings
+    snapshot_header header;
+    auto valid = mapping_size_ >= sizeof(header);
+    if (valid)
+    {
+        std::memcpy(&header, mapping_, sizeof(header));
+        auto table_size = header.table_size;
+        valid = std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) == 0
+             && header.version == snapshot_version
+             && header.hash_size == sizeof(hash_type)
+             && table_size != 0u && (table_size & (table_size - 1)) == 0u
+             && header.no_strings < table_size
+             && table_size <= (mapping_size_ - sizeof(header)) / sizeof(entry)
+             && header.strings_size == mapping_size_ - sizeof(header) - table_size * sizeof(entry)
+             && (header.strings_size == 0u
+                 || static_cast<const char*>(mapping_)[mapping_size_ - 1] == 0);
+    }
+    if (valid)
+    {
+        // validate the entries:
+        // the strings section ends with a null-terminator, so each string ends inside of it if its offset does,
+        // and there must be an empty entry, otherwise find_snapshot() doesn't terminate
+        auto table = static_cast<const entry*>(static_cast<const void*>(static_cast<const char*>(mapping_)
+                                                                         + sizeof(header)));
+        std::uint64_t no_occupied = 0u;
+        for (std::uint64_t i = 0u; valid && i != header.table_size; ++i)
+            if (table[i].offset != empty_offset)
+            {
+                valid = table[i].offset < header.strings_size;
+                ++no_occupied;
+            }
+        valid = valid && no_occupied == header.no_strings;
+    }
+    if (!valid)
+    {
+        unmap_file(mapping_, mapping_size_);
+        throw snapshot_error(path, "not a valid snapshot file");
+    }
+
+    auto mem = static_cast<const char*>(mapping_);
+    table_ = static_cast<const entry*>(static_cast<const void*>(mem + sizeof(header)));
+    table_mask_ = static_cast<std::size_t>(header.table_size - 1);
+    no_strings_ = static_cast<std::size_t>(header.no_strings);
+    strings_ = mem + sizeof(header) + header.table_size * sizeof(entry);
+}
+
+sid::snapshot_database::~snapshot_database() FOONATHAN_NOEXCEPT
+{
+    unmap_file(mapping_, mapping_size_);
+}
+
+sid::basic_database::insert_status sid::snapshot_database::insert(hash_type hash, const char *str, std::size_t length)
+{
+    if (auto stored = find_snapshot(hash))
+        return compare(stored, "", 0u, str, length);
+    return overlay_.insert(hash, str, length);
+}
+
+sid::basic_database::insert_status sid::snapshot_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                         const char *str, std::size_t length)
+{
+    auto prefix_str = find_snapshot(prefix);
+    if (auto stored = find_snapshot(hash))
+    {
+        auto full_prefix = prefix_str ? prefix_str : overlay_.lookup(prefix);
+        return compare(stored, full_prefix, std::strlen(full_prefix), str, length);
+    }
+    else if (!prefix_str)
+        // prefix is stored in the overlay as well
+        return overlay_.insert_prefix(hash, prefix, str, length);
+
+    std::string full(prefix_str);
+    full.append(str, length);
+    return overlay_.insert(hash, full.c_str(), full.size());
+}
+
+const char* sid::snapshot_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto stored = find_snapshot(hash);
+    return stored ? stored : overlay_.lookup(hash);
+}
+
+const char* sid::snapshot_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    auto stored = find_snapshot(hash);
+    return stored ? stored : overlay_.find(hash);
+}
+
+sid::database_statistics sid::snapshot_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    auto result = overlay_.statistics();
+    auto snapshot_strings = mapping_size_ - static_cast<std::size_t>(strings_ - static_cast<const char*>(mapping_));
+    result.no_strings += no_strings_;
+    result.no_buckets += table_mask_ + 1;
+    result.string_bytes += snapshot_strings;
+    result.overhead_bytes += mapping_size_ - snapshot_strings;
+    return result;
+}
+
+const char* sid::snapshot_database::find_snapshot(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    for (auto i = static_cast<std::size_t>(hash) & table_mask_;; i = (i + 1) & table_mask_)
+    {
+        auto &e = table_[i];
+        if (e.offset == empty_offset)
+            return nullptr;
+        else if (e.hash == hash)
+            return strings_ + e.offset;
+    }
+}
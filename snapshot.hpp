@@ -0,0 +1,92 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_SNAPSHOT_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_SNAPSHOT_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief Writes all strings stored in a \ref map_database into a snapshot file.
+    /// \detail The file consists of a header, an open addressing hash table and all strings.
+    /// It can be loaded by \ref snapshot_database.<br>
+    /// The format uses the native byte order and \ref hash_type, it is not meant to be portable across platforms.<br>
+    /// Throws \ref snapshot_error on failure.
+    void save_snapshot(const map_database &db, const char *path);
+
+    class snapshot_database;
+
+    /// \brief Writes all strings stored in a \ref snapshot_database, including the newly inserted ones,
+    /// into a snapshot file.
+    /// \detail The path must not be the one of the file currently mapped by the database.
+    void save_snapshot(const snapshot_database &db, const char *path);
+
+    /// \brief A database that serves strings from a snapshot file.
+    /// \detail The file is mapped into memory and \c lookup() returns pointers into the mapping directly,
+    /// loading does neither copy nor allocate the strings.<br>
+    /// Strings that are not part of the snapshot are inserted into an ordinary \ref map_database.
+    /// Like it, this database is not thread safe.
+    class snapshot_database : public basic_database
+    {
+    public:
+        /// \brief Maps a snapshot file written by \ref save_snapshot.
+        /// \detail Throws \ref snapshot_error if it can't be mapped or is not a valid snapshot.
+        /// Besides the header, each entry of the hash table is checked,
+        /// so a corrupt file can't cause reads outside of the mapping.<br>
+        /// The arguments are forwarded to the \ref map_database storing new strings.
+        explicit snapshot_database(const char *path, std::size_t size = 1024, double max_load_factor = 1.0);
+        ~snapshot_database() FOONATHAN_NOEXCEPT;
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the statistics of the overlay with the strings of the snapshot added.
+        /// \detail The mapped memory counts as allocated.
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Returns the number of strings stored in the snapshot file.
+        std::size_t snapshot_size() const FOONATHAN_NOEXCEPT
+        {
+            return no_strings_;
+        }
+
+        /// \brief Returns the database storing the strings that are not part of the snapshot.
+        const map_database& overlay() const FOONATHAN_NOEXCEPT
+        {
+            return overlay_;
+        }
+
+    private:
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
+        struct entry;
+
+        // returns nullptr if the hash isn't part of the snapshot
+        const char* find_snapshot(hash_type hash) const FOONATHAN_NOEXCEPT;
+
+        void *mapping_;
+        std::size_t mapping_size_;
+        const entry *table_;
+        std::size_t table_mask_, no_strings_;
+        const char *strings_;
+        map_database overlay_;
+
+        friend void save_snapshot(const map_database &db, const char *path);
+        friend void save_snapshot(const snapshot_database &db, const char *path);
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_SNAPSHOT_HPP_INCLUDED
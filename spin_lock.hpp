@@ -0,0 +1,209 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_SPIN_LOCK_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_SPIN_LOCK_HPP_INCLUDED
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "config.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define FOONATHAN_STRING_ID_IMPL_PAUSE() _mm_pause()
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    #define FOONATHAN_STRING_ID_IMPL_PAUSE() __asm__ __volatile__("yield")
+#else
+    #define FOONATHAN_STRING_ID_IMPL_PAUSE()
+#endif
+
+namespace foonathan { namespace string_id
+{
+    namespace detail
+    {
+        // waits exponentially longer on each call, then gives up the time slice
+        class backoff
+        {
+        public:
+            backoff() FOONATHAN_NOEXCEPT
+            : count_(1u) {}
+
+            void operator()() FOONATHAN_NOEXCEPT
+            {
+                if (count_ > max_count)
+                {
+                    // the owner might not be running at all
+                    std::this_thread::yield();
+                    return;
+                }
+                for (auto i = 0u; i != count_; ++i)
+                    FOONATHAN_STRING_ID_IMPL_PAUSE();
+                count_ *= 2u;
+            }
+
+        private:
+            static FOONATHAN_CONSTEXPR unsigned max_count = 64u;
+
+            unsigned count_;
+        };
+    } // namespace detail
+
+    /// \brief A lock that busy waits instead of blocking the thread.
+    /// \detail It waits exponentially longer between tries and yields the thread after a while.<br>
+    /// It can be used as lock of \ref thread_safe_database if the operations are short,
+    /// then it is cheaper than a \c std::mutex, but it is not fair.
+    class spin_lock
+    {
+    public:
+        spin_lock() FOONATHAN_NOEXCEPT
+        : locked_(false) {}
+
+        spin_lock(const spin_lock &) = delete;
+        spin_lock& operator=(const spin_lock &) = delete;
+
+        void lock() FOONATHAN_NOEXCEPT
+        {
+            detail::backoff wait;
+            // only tries to write if it is free, so waiting threads don't steal the cache line
+            while (locked_.load(std::memory_order_relaxed) || locked_.exchange(true, std::memory_order_acquire))
+                wait();
+        }
+
+        bool try_lock() FOONATHAN_NOEXCEPT
+        {
+            return !locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() FOONATHAN_NOEXCEPT
+        {
+            locked_.store(false, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<bool> locked_;
+    };
+
+    /// \brief A fair lock that busy waits.
+    /// \detail Each thread draws a ticket and waits until it is served,
+    /// so the threads get the lock in the order they have called \c lock().<br>
+    /// It can be used as lock of \ref thread_safe_database,
+    /// but a waiting thread that is not running blocks all threads behind it,
+    /// so it should only be used if there are not more threads than cores.
+    class ticket_lock
+    {
+    public:
+        ticket_lock() FOONATHAN_NOEXCEPT
+        : next_(0u), serving_(0u) {}
+
+        ticket_lock(const ticket_lock &) = delete;
+        ticket_lock& operator=(const ticket_lock &) = delete;
+
+        void lock() FOONATHAN_NOEXCEPT
+        {
+            auto ticket = next_.fetch_add(1u, std::memory_order_relaxed);
+            detail::backoff wait;
+            while (serving_.load(std::memory_order_acquire) != ticket)
+                wait();
+        }
+
+        bool try_lock() FOONATHAN_NOEXCEPT
+        {
+            // synchronizes with unlock()
+            auto ticket = serving_.load(std::memory_order_acquire);
+            auto expected = ticket;
+            return next_.compare_exchange_strong(expected, ticket + 1u, std::memory_order_relaxed);
+        }
+
+        void unlock() FOONATHAN_NOEXCEPT
+        {
+            // only the owner writes it
+            serving_.store(serving_.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+        }
+
+    private:
+        std::atomic<std::uint32_t> next_, serving_;
+    };
+
+    /// \brief A reader/writer lock that busy waits.
+    /// \detail Multiple threads can hold it shared via \c lock_shared() or a single one exclusive via \c lock().
+    /// A waiting writer blocks new readers, so writers do not starve.<br>
+    /// If it is used as lock of \ref thread_safe_database, \c lookup() and \c find() only take it shared,
+    /// this is a gain if they are much more frequent than insertions.
+    class shared_spin_lock
+    {
+    public:
+        shared_spin_lock() FOONATHAN_NOEXCEPT
+        : state_(0u) {}
+
+        shared_spin_lock(const shared_spin_lock &) = delete;
+        shared_spin_lock& operator=(const shared_spin_lock &) = delete;
+
+        void lock() FOONATHAN_NOEXCEPT
+        {
+            detail::backoff wait;
+            while (!try_lock())
+            {
+                auto state = state_.load(std::memory_order_relaxed);
+                if ((state & writer_waiting) == 0u)
+                    state_.fetch_or(writer_waiting, std::memory_order_relaxed);
+                wait();
+            }
+        }
+
+        bool try_lock() FOONATHAN_NOEXCEPT
+        {
+            // clears writer_waiting, other waiting writers set it again
+            auto state = state_.load(std::memory_order_relaxed);
+            return (state & ~writer_waiting) == 0u
+                && state_.compare_exchange_strong(state, writer_locked,
+                                                  std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() FOONATHAN_NOEXCEPT
+        {
+            state_.fetch_and(~writer_locked, std::memory_order_release);
+        }
+
+        void lock_shared() FOONATHAN_NOEXCEPT
+        {
+            detail::backoff wait;
+            for (auto state = state_.load(std::memory_order_relaxed);;)
+            {
+                if ((state & (writer_locked | writer_waiting)) != 0u)
+                {
+                    wait();
+                    state = state_.load(std::memory_order_relaxed);
+                }
+                // on failure, another reader was faster and state is updated, so try again immediately
+                else if (state_.compare_exchange_weak(state, state + 1u,
+                                                      std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+            }
+        }
+
+        bool try_lock_shared() FOONATHAN_NOEXCEPT
+        {
+            auto state = state_.load(std::memory_order_relaxed);
+            return (state & (writer_locked | writer_waiting)) == 0u
+                && state_.compare_exchange_strong(state, state + 1u,
+                                                  std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock_shared() FOONATHAN_NOEXCEPT
+        {
+            state_.fetch_sub(1u, std::memory_order_release);
+        }
+
+    private:
+        // the remaining bits are the number of readers
+        static FOONATHAN_CONSTEXPR std::uint32_t writer_locked = 1u << 31;
+        static FOONATHAN_CONSTEXPR std::uint32_t writer_waiting = 1u << 30;
+
+        std::atomic<std::uint32_t> state_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_SPIN_LOCK_HPP_INCLUDED
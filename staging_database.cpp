@@ -0,0 +1,88 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include "staging_database.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace sid = foonathan::string_id;
+
+sid::staging_database::staging_database(std::size_t size)
+: local_(new map_database(size, 1.0, map_database::arena_storage)), initial_size_(size) {}
+
+sid::basic_database::insert_status sid::staging_database::insert(hash_type hash, const char *str,
+                                                                 std::size_t length)
+{
+    return local_->insert(hash, str, length);
+}
+
+sid::basic_database::insert_status sid::staging_database::insert_prefix(hash_type hash, hash_type prefix,
+                                                                        const char *str, std::size_t length)
+{
+    return local_->insert_prefix(hash, prefix, str, length);
+}
+
+sid::basic_database::insert_status sid::staging_database::insert_segments(hash_type hash,
+                                                                          const string_info *segments,
+                                                                          std::size_t count)
+{
+    return local_->insert_segments(hash, segments, count);
+}
+
+const char* sid::staging_database::lookup(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    return local_->lookup(hash);
+}
+
+const char* sid::staging_database::find(hash_type hash) const FOONATHAN_NOEXCEPT
+{
+    return local_->find(hash);
+}
+
+bool sid::staging_database::erase(hash_type hash)
+{
+    if (!local_->erase(hash))
+        return false;
+    // the intern cache stores this database, not the local one
+    invalidate_caches();
+    return true;
+}
+
+sid::database_statistics sid::staging_database::statistics() const FOONATHAN_NOEXCEPT
+{
+    return local_->statistics();
+}
+
+std::size_t sid::staging_database::merge_into(basic_database &db, const merge_callback &f)
+{
+    auto count = size();
+    std::vector<hash_type> hashes;
+    std::vector<string_info> strings;
+    hashes.reserve(count);
+    strings.reserve(count);
+    local_->for_each([&](hash_type hash, const char *str, std::size_t length)
+                     {
+                         hashes.push_back(hash);
+                         strings.emplace_back(str, length);
+                     });
+
+    std::vector<insert_status> status(count);
+    std::unique_ptr<map_database> empty(new map_database(initial_size_, 1.0, map_database::arena_storage));
+    db.insert_batch(hashes.data(), strings.data(), status.data(), count);
+
+    std::size_t no_collisions = 0u;
+    for (std::size_t i = 0u; i != count; ++i)
+    {
+        if (status[i] == collision)
+            ++no_collisions;
+        if (f)
+            f(hashes[i], strings[i].string, status[i]);
+    }
+
+    // the old strings are freed at once
+    local_ = std::move(empty);
+    invalidate_caches();
+    return no_collisions;
+}
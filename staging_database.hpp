@@ -0,0 +1,71 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_STAGING_DATABASE_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_STAGING_DATABASE_HPP_INCLUDED
+
+#include <functional>
+#include <memory>
+
+#include "basic_database.hpp"
+#include "config.hpp"
+#include "database.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \brief A database collecting strings that are later moved into another database at once.
+    /// \detail It is meant to be used by a single thread without any synchronization,
+    /// e.g. one per worker thread, which publishes its strings to a shared database via \ref merge_into().
+    /// The merge uses a single \c insert_batch() call, so a \ref thread_safe_database is only locked once.<br>
+    /// The strings are stored in a \ref map_database using \c arena_storage.
+    /// Collisions between them are detected on insertion,
+    /// collisions with strings of the shared database only by \ref merge_into().
+    class staging_database : public basic_database
+    {
+    public:
+        /// \brief The type of the function called for each string by \ref merge_into().
+        /// \detail It gets the hash, the string and the \ref insert_status in the other database.
+        typedef std::function<void(hash_type, const char*, insert_status)> merge_callback;
+
+        /// \brief Creates an empty database.
+        /// \detail \c size is the initial number of buckets of the \ref map_database.
+        explicit staging_database(std::size_t size = 256);
+
+        insert_status insert(hash_type hash, const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_prefix(hash_type hash, hash_type prefix,
+                                    const char *str, std::size_t length) FOONATHAN_OVERRIDE;
+        insert_status insert_segments(hash_type hash, const string_info *segments,
+                                      std::size_t count) FOONATHAN_OVERRIDE;
+        const char* lookup(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+        const char* find(hash_type hash) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+        bool erase(hash_type hash) FOONATHAN_OVERRIDE;
+        database_statistics statistics() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE;
+
+        /// \brief Moves all strings into another database.
+        /// \detail They are inserted via a single call to \c insert_batch() and removed from this database afterwards,
+        /// ids created with it have to be created again with the other database.<br>
+        /// \c f is called for each string with its \ref insert_status in the other database,
+        /// in an unspecified order.
+        /// If the insertion throws, nothing is removed.
+        /// \return The number of strings that resulted in a collision.
+        std::size_t merge_into(basic_database &db, const merge_callback &f = nullptr);
+
+        /// \brief Returns the number of strings stored.
+        std::size_t size() const FOONATHAN_NOEXCEPT
+        {
+            return local_->statistics().no_strings;
+        }
+
+    private:
+        bool cacheable() const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return true;
+        }
+
+        std::unique_ptr<map_database> local_;
+        std::size_t initial_size_;
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_STAGING_DATABASE_HPP_INCLUDED
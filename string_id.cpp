@@ -4,18 +4,71 @@
 
 #include "string_id.hpp"
 
+#include <cstring>
+
+#include "database.hpp"
 #include "error.hpp"
 
 namespace sid = foonathan::string_id;
 
+void sid::detail::handle_collision(basic_database &db, hash_type hash, const char *str)
+{
+    auto handler = get_collision_handler();
+    auto second = db.lookup(hash);
+    handler(hash, str, second);
+}
+
 namespace
 {
-    void handle_collision(sid::basic_database &db, sid::hash_type hash, const char *str)
+#if FOONATHAN_STRING_ID_INTERN_CACHE
+    // direct mapped cache of strings each thread has inserted into a database
+    // an entry is only valid as long as the cache id of the database hasn't changed,
+    // since cache ids are never reused this also covers destroyed databases
+    class intern_cache
     {
-        auto handler = sid::get_collision_handler();
-        auto second = db.lookup(hash);
-        handler(hash, str, second);
-    }
+    public:
+        // returns true if the string is known to be stored in the database with the given cache id
+        static bool contains(std::uint64_t cache_id, sid::hash_type hash,
+                             const char *str, std::size_t length) FOONATHAN_NOEXCEPT
+        {
+            auto &e = get_entry(hash);
+            return cache_id != 0u && e.hash == hash && e.cache_id == cache_id
+                && e.length == length && std::memcmp(e.str, str, length) == 0;
+        }
+
+        // cache_id must be obtained before the string was inserted
+        static void add(std::uint64_t cache_id, sid::hash_type hash,
+                        const char *str, std::size_t length) FOONATHAN_NOEXCEPT
+        {
+            if (cache_id == 0u || length > max_length)
+                return;
+            auto &e = get_entry(hash);
+            e.hash = hash;
+            e.cache_id = cache_id;
+            e.length = static_cast<unsigned char>(length);
+            std::memcpy(e.str, str, length);
+        }
+
+    private:
+        static FOONATHAN_CONSTEXPR std::size_t size = 64u; // must be a power of two
+        static FOONATHAN_CONSTEXPR std::size_t max_length = 47u; // so that an entry has 64 bytes
+
+        struct entry
+        {
+            sid::hash_type hash;
+            std::uint64_t cache_id;
+            unsigned char length;
+            char str[max_length];
+        };
+
+        static entry& get_entry(sid::hash_type hash) FOONATHAN_NOEXCEPT
+        {
+            // zero-initialized, cache id 0 is never valid
+            thread_local entry entries[size];
+            return entries[static_cast<std::size_t>(hash) & (size - 1)];
+        }
+    };
+#endif
 }
 
 sid::string_id::string_id(string_info str, basic_database &db)
@@ -23,14 +76,27 @@ sid::string_id::string_id(string_info str, basic_database &db)
     basic_database::insert_status status;
     *this = string_id(str, db, status);
     if (!status)
-        handle_collision(*db_, id_, str.string);
+        detail::handle_collision(*db_, id_, str.string);
 }
 
 sid::string_id::string_id(string_info str, basic_database &db,
                           basic_database::insert_status &status)
-: id_(detail::sid_hash(str.string)), db_(&db)
+: id_(detail::sid_hash_n(str.string, str.length)), db_(&db)
 {
+#if FOONATHAN_STRING_ID_INTERN_CACHE
+    // 0 if the database is not cacheable
+    auto cache_id = db.cache_id();
+    if (intern_cache::contains(cache_id, id_, str.string, str.length))
+    {
+        status = basic_database::old_string;
+        return;
+    }
     status = db_->insert(id_, str.string, str.length);
+    if (status)
+        intern_cache::add(cache_id, id_, str.string, str.length);
+#else
+    status = db_->insert(id_, str.string, str.length);
+#endif
 }
 
 sid::string_id::string_id(const string_id &prefix, string_info str)
@@ -38,16 +104,109 @@ sid::string_id::string_id(const string_id &prefix, string_info str)
     basic_database::insert_status status;
     *this = string_id(prefix, str, status);
     if (!status)
-        handle_collision(*db_, id_, str.string);
+        detail::handle_collision(*db_, id_, str.string);
 }
 
 sid::string_id::string_id(const string_id &prefix, string_info str,
                           basic_database::insert_status &status)
-: id_(detail::sid_hash(str.string, prefix.hash_code())), db_(prefix.db_)
+: id_(detail::sid_hash_n(str.string, str.length, prefix.hash_code())), db_(prefix.db_)
 {
     status = db_->insert_prefix(id_, prefix.hash_code(), str.string, str.length);
 }
 
+std::vector<sid::string_id> sid::make_string_ids(const string_info *strings, std::size_t count,
+                                                 basic_database &db)
+{
+    std::vector<basic_database::insert_status> status(count);
+    auto result = make_string_ids(strings, count, db, status.data());
+    for (std::size_t i = 0u; i != count; ++i)
+        if (!status[i])
+            detail::handle_collision(db, result[i].hash_code(), strings[i].string);
+    return result;
+}
+
+std::vector<sid::string_id> sid::make_string_ids(const string_info *strings, std::size_t count,
+                                                 basic_database &db, basic_database::insert_status *status)
+{
+    std::vector<hash_type> hashes;
+    hashes.reserve(count);
+    std::vector<string_id> result;
+    result.reserve(count);
+    for (std::size_t i = 0u; i != count; ++i)
+    {
+        hashes.push_back(detail::sid_hash_n(strings[i].string, strings[i].length));
+        result.push_back(string_id(hashes.back(), &db));
+    }
+    db.insert_batch(hashes.data(), strings, status, count);
+    return result;
+}
+
+std::vector<sid::string_id> sid::make_string_ids(const string_id &prefix, const string_info *strings,
+                                                 std::size_t count)
+{
+    std::vector<basic_database::insert_status> status(count);
+    auto result = make_string_ids(prefix, strings, count, status.data());
+    for (std::size_t i = 0u; i != count; ++i)
+        if (!status[i])
+        {
+            std::string str = prefix.string();
+            str.append(strings[i].string, strings[i].length);
+            detail::handle_collision(prefix.database(), result[i].hash_code(), str.c_str());
+        }
+    return result;
+}
+
+std::vector<sid::string_id> sid::make_string_ids(const string_id &prefix, const string_info *strings,
+                                                 std::size_t count, basic_database::insert_status *status)
+{
+    std::vector<hash_type> hashes;
+    hashes.reserve(count);
+    std::vector<string_id> result;
+    result.reserve(count);
+    for (std::size_t i = 0u; i != count; ++i)
+    {
+        hashes.push_back(detail::sid_hash_n(strings[i].string, strings[i].length, prefix.hash_code()));
+        result.push_back(string_id(hashes.back(), prefix.db_));
+    }
+    prefix.db_->insert_prefix_batch(hashes.data(), prefix.hash_code(), strings, status, count);
+    return result;
+}
+
+sid::string_id sid::make_string_id(const string_info *segments, std::size_t count, basic_database &db)
+{
+    basic_database::insert_status status;
+    auto result = make_string_id(segments, count, db, status);
+    if (!status)
+    {
+        auto str = detail::concatenate(segments, count);
+        detail::handle_collision(db, result.hash_code(), str.c_str());
+    }
+    return result;
+}
+
+sid::string_id sid::make_string_id(const string_info *segments, std::size_t count,
+                                   basic_database &db, basic_database::insert_status &status)
+{
+    auto hash = detail::fnv_basis;
+    for (auto cur = segments; cur != segments + count; ++cur)
+        hash = detail::sid_hash_n(cur->string, cur->length, hash);
+    status = db.insert_segments(hash, segments, count);
+    return string_id(hash, &db);
+}
+
+std::vector<sid::string_id> sid::make_string_id_path(const string_info *segments, std::size_t count,
+                                                     basic_database &db)
+{
+    std::vector<string_id> result;
+    result.reserve(count);
+    if (count == 0u)
+        return result;
+    result.push_back(string_id(segments[0], db));
+    for (std::size_t i = 1u; i != count; ++i)
+        result.push_back(string_id(result.back(), segments[i]));
+    return result;
+}
+
 const char* sid::string_id::string() const FOONATHAN_NOEXCEPT
 {
     return db_->lookup(id_);
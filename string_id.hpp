@@ -5,8 +5,8 @@
 #ifndef FOONATHAN_STRING_ID_HPP_INCLUDED
 #define FOONATHAN_STRING_ID_HPP_INCLUDED
 
-#include <cstring>
 #include <functional>
+#include <vector>
 
 #include "basic_database.hpp"
 #include "config.hpp"
@@ -14,25 +14,12 @@
 
 namespace foonathan { namespace string_id
 {
-    /// \brief Information about a string.
-    /// \detail It is used to reduce the number of constructors of \ref string_id.
-    struct string_info
+    namespace detail
     {
-        /// \brief A pointer to a null-terminated string.
-        const char *string;
-        /// \brief The length of this string.
-        std::size_t length;
-        
-        /// \brief Creates it from a null-terminated string (implicit conversion).
-        string_info(const char *str) FOONATHAN_NOEXCEPT
-        : string(str), length(std::strlen(str)) {}
-        
-        /// \brief Creates it from a string with given length.
-        /// \arg \c str does not need to be null-terminated.
-        string_info(const char *str, std::size_t length)
-        : string(str), length(length) {}
-    };
-    
+        // calls the collision handler with str and the string stored in db
+        void handle_collision(basic_database &db, hash_type hash, const char *str);
+    } // namespace detail
+
     /// \brief The string identifier class.
     /// \detail This is a lightweight class to store strings.<br>
     /// It only stores a hash of the string allowing fast copying and comparisons.
@@ -115,9 +102,66 @@ namespace foonathan { namespace string_id
         /// @}
         
     private:
+        string_id(hash_type id, basic_database *db) FOONATHAN_NOEXCEPT
+        : id_(id), db_(db) {}
+
+        friend std::vector<string_id> make_string_ids(const string_info *strings, std::size_t count,
+                                                      basic_database &db);
+        friend std::vector<string_id> make_string_ids(const string_info *strings, std::size_t count,
+                                                      basic_database &db, basic_database::insert_status *status);
+        friend std::vector<string_id> make_string_ids(const string_id &prefix, const string_info *strings,
+                                                      std::size_t count, basic_database::insert_status *status);
+        friend string_id make_string_id(const string_info *segments, std::size_t count,
+                                        basic_database &db, basic_database::insert_status &status);
+
         hash_type id_;
         basic_database *db_;
     };
+
+    /// \brief Creates multiple ids at once.
+    /// \detail It hashes all \c count strings and inserts them into the database
+    /// with a single call to \ref basic_database::insert_batch.<br>
+    /// If it encounters a collision, the \ref collision_handler will be called.
+    std::vector<string_id> make_string_ids(const string_info *strings, std::size_t count,
+                                           basic_database &db);
+
+    /// \brief Same as other version but instead of calling the \ref collision_handler,
+    /// it sets the \c status array of size \c count to the appropriate status.
+    std::vector<string_id> make_string_ids(const string_info *strings, std::size_t count,
+                                           basic_database &db, basic_database::insert_status *status);
+
+    /// \brief Creates multiple ids with the same prefix at once.
+    /// \detail The result is the same as using the prefix constructor for each string,
+    /// but the strings are inserted with a single call to \ref basic_database::insert_prefix_batch.<br>
+    /// If it encounters a collision, the \ref collision_handler will be called.
+    std::vector<string_id> make_string_ids(const string_id &prefix, const string_info *strings,
+                                           std::size_t count);
+
+    /// \brief Same as other version but instead of calling the \ref collision_handler,
+    /// it sets the \c status array of size \c count to the appropriate status.
+    std::vector<string_id> make_string_ids(const string_id &prefix, const string_info *strings,
+                                           std::size_t count, basic_database::insert_status *status);
+
+    /// \brief Creates the id of a string given as a sequence of segments, e.g. the parts of a path.
+    /// \detail The hash is computed incrementally over all \c count segments
+    /// and the string is inserted with a single call to \ref basic_database::insert_segments,
+    /// there is no temporary concatenation if the database supports it.
+    /// The result is the same as creating nested ids using the prefix constructor,
+    /// but the intermediate strings are not stored.<br>
+    /// If it encounters a collision, the \ref collision_handler will be called.
+    string_id make_string_id(const string_info *segments, std::size_t count, basic_database &db);
+
+    /// \brief Same as other version but instead of calling the \ref collision_handler,
+    /// it sets the output parameter to the appropriate status.
+    string_id make_string_id(const string_info *segments, std::size_t count,
+                             basic_database &db, basic_database::insert_status &status);
+
+    /// \brief Creates the ids of all prefixes of a string given as a sequence of segments.
+    /// \detail Element \c i of the result is the id of the first <tt>i + 1</tt> segments,
+    /// each of them is inserted using the prefix constructor.<br>
+    /// Use it instead of \ref make_string_id if the intermediate strings are needed as well.
+    std::vector<string_id> make_string_id_path(const string_info *segments, std::size_t count,
+                                               basic_database &db);
     
     namespace literals
     {
@@ -0,0 +1,612 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_STRING_ID_MAP_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_STRING_ID_MAP_HPP_INCLUDED
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "hash.hpp"
+#include "string_id.hpp"
+
+namespace foonathan { namespace string_id
+{
+    /// \cond impl
+    namespace detail
+    {
+        inline const string_id& get_key(const string_id &id) FOONATHAN_NOEXCEPT
+        {
+            return id;
+        }
+
+        template <typename T>
+        const string_id& get_key(const std::pair<const string_id, T> &value) FOONATHAN_NOEXCEPT
+        {
+            return value.first;
+        }
+
+        // control bytes of id_table
+        // full slots store the upper 7 bits of the hash, so they are always non-negative
+        enum id_ctrl : signed char
+        {
+            id_ctrl_empty = -128,
+            id_ctrl_deleted = -1,
+            id_ctrl_end = 0 // sentinel after the last slot, stops iteration
+        };
+
+        inline signed char id_ctrl_hash(hash_type hash) FOONATHAN_NOEXCEPT
+        {
+            return static_cast<signed char>(hash >> (sizeof(hash_type) * CHAR_BIT - 7));
+        }
+
+        template <class Value>
+        class id_table;
+
+        template <class Value>
+        class id_table_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef typename std::remove_const<Value>::type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef Value* pointer;
+            typedef Value& reference;
+
+            id_table_iterator() FOONATHAN_NOEXCEPT
+            : ctrl_(nullptr), slot_(nullptr) {}
+
+            // iterator to const_iterator
+            template <class Other,
+                      typename = typename std::enable_if<std::is_convertible<Other*, Value*>::value>::type>
+            id_table_iterator(const id_table_iterator<Other> &other) FOONATHAN_NOEXCEPT
+            : ctrl_(other.ctrl_), slot_(other.slot_) {}
+
+            reference operator*() const FOONATHAN_NOEXCEPT
+            {
+                return *slot_;
+            }
+
+            pointer operator->() const FOONATHAN_NOEXCEPT
+            {
+                return slot_;
+            }
+
+            id_table_iterator& operator++() FOONATHAN_NOEXCEPT
+            {
+                ++ctrl_;
+                ++slot_;
+                skip_empty();
+                return *this;
+            }
+
+            id_table_iterator operator++(int) FOONATHAN_NOEXCEPT
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(const id_table_iterator &a, const id_table_iterator &b) FOONATHAN_NOEXCEPT
+            {
+                return a.slot_ == b.slot_;
+            }
+
+            friend bool operator!=(const id_table_iterator &a, const id_table_iterator &b) FOONATHAN_NOEXCEPT
+            {
+                return !(a == b);
+            }
+
+        private:
+            id_table_iterator(const signed char *ctrl, Value *slot) FOONATHAN_NOEXCEPT
+            : ctrl_(ctrl), slot_(slot) {}
+
+            void skip_empty() FOONATHAN_NOEXCEPT
+            {
+                while (*ctrl_ < 0)
+                {
+                    ++ctrl_;
+                    ++slot_;
+                }
+            }
+
+            const signed char *ctrl_;
+            Value *slot_;
+
+            template <class>
+            friend class id_table_iterator;
+            template <class>
+            friend class id_table;
+        };
+
+        // open addressing hash table with linear probing storing the values inline
+        // the slot is selected by the lower bits of the hash, the control byte stores the upper bits,
+        // so most slots that do not match are rejected without touching the values
+        template <class Value>
+        class id_table
+        {
+            // keys of a set must not be modified
+            typedef typename std::conditional<std::is_same<Value, string_id>::value,
+                                              const Value, Value>::type iterator_value;
+        public:
+            typedef string_id key_type;
+            typedef Value value_type;
+            typedef std::size_t size_type;
+            typedef id_table_iterator<iterator_value> iterator;
+            typedef id_table_iterator<const Value> const_iterator;
+
+            id_table() FOONATHAN_NOEXCEPT
+            : ctrl_(nullptr), slots_(nullptr), capacity_(0u), size_(0u), growth_left_(0u) {}
+
+            explicit id_table(size_type size)
+            : id_table()
+            {
+                reserve(size);
+            }
+
+            id_table(const id_table &other)
+            : id_table()
+            {
+                if (other.size_ == 0u)
+                    return;
+                allocate(other.capacity_);
+                // same capacity, so every value can stay in its slot
+                for (size_type i = 0u; i != capacity_; ++i)
+                    if (other.ctrl_[i] >= 0)
+                    {
+                        ::new(static_cast<void*>(slots_ + i)) Value(other.slots_[i]);
+                        ctrl_[i] = other.ctrl_[i];
+                        ++size_;
+                    }
+                    else
+                        ctrl_[i] = other.ctrl_[i];
+                growth_left_ = other.growth_left_;
+            }
+
+            id_table(id_table &&other) FOONATHAN_NOEXCEPT
+            : id_table()
+            {
+                swap(other);
+            }
+
+            ~id_table() FOONATHAN_NOEXCEPT
+            {
+                destroy_values();
+                ::operator delete(slots_);
+                delete[] ctrl_;
+            }
+
+            id_table& operator=(id_table other) FOONATHAN_NOEXCEPT
+            {
+                swap(other);
+                return *this;
+            }
+
+            void swap(id_table &other) FOONATHAN_NOEXCEPT
+            {
+                std::swap(ctrl_, other.ctrl_);
+                std::swap(slots_, other.slots_);
+                std::swap(capacity_, other.capacity_);
+                std::swap(size_, other.size_);
+                std::swap(growth_left_, other.growth_left_);
+            }
+
+            friend void swap(id_table &a, id_table &b) FOONATHAN_NOEXCEPT
+            {
+                a.swap(b);
+            }
+
+            //=== iterators ===//
+            iterator begin() FOONATHAN_NOEXCEPT
+            {
+                return first<iterator>();
+            }
+
+            const_iterator begin() const FOONATHAN_NOEXCEPT
+            {
+                return first<const_iterator>();
+            }
+
+            const_iterator cbegin() const FOONATHAN_NOEXCEPT
+            {
+                return begin();
+            }
+
+            iterator end() FOONATHAN_NOEXCEPT
+            {
+                return iterator(ctrl_ + capacity_, slots_ + capacity_);
+            }
+
+            const_iterator end() const FOONATHAN_NOEXCEPT
+            {
+                return const_iterator(ctrl_ + capacity_, slots_ + capacity_);
+            }
+
+            const_iterator cend() const FOONATHAN_NOEXCEPT
+            {
+                return end();
+            }
+
+            //=== capacity ===//
+            bool empty() const FOONATHAN_NOEXCEPT
+            {
+                return size_ == 0u;
+            }
+
+            size_type size() const FOONATHAN_NOEXCEPT
+            {
+                return size_;
+            }
+
+            // number of slots
+            size_type capacity() const FOONATHAN_NOEXCEPT
+            {
+                return capacity_;
+            }
+
+            // allocates enough slots for size values
+            void reserve(size_type size)
+            {
+                auto capacity = min_capacity;
+                while (max_items(capacity) < size)
+                    capacity *= 2;
+                if (capacity > capacity_)
+                    rehash(capacity);
+            }
+
+            //=== lookup ===//
+            iterator find(const string_id &id) FOONATHAN_NOEXCEPT
+            {
+                return make_iterator<iterator>(find_index(id.hash_code(), match_id{id}));
+            }
+
+            const_iterator find(const string_id &id) const FOONATHAN_NOEXCEPT
+            {
+                return make_iterator<const_iterator>(find_index(id.hash_code(), match_id{id}));
+            }
+
+            // finds any id with the given hash, i.e. the database is ignored
+            iterator find(hash_type hash) FOONATHAN_NOEXCEPT
+            {
+                return make_iterator<iterator>(find_index(hash, match_hash{hash}));
+            }
+
+            const_iterator find(hash_type hash) const FOONATHAN_NOEXCEPT
+            {
+                return make_iterator<const_iterator>(find_index(hash, match_hash{hash}));
+            }
+
+            size_type count(const string_id &id) const FOONATHAN_NOEXCEPT
+            {
+                return find_index(id.hash_code(), match_id{id}) == capacity_ ? 0u : 1u;
+            }
+
+            size_type count(hash_type hash) const FOONATHAN_NOEXCEPT
+            {
+                return find_index(hash, match_hash{hash}) == capacity_ ? 0u : 1u;
+            }
+
+            //=== modifiers ===//
+            // other iterators stay valid
+            iterator erase(const_iterator pos) FOONATHAN_NOEXCEPT
+            {
+                auto i = static_cast<size_type>(pos.slot_ - slots_);
+                erase_index(i);
+                iterator result(ctrl_ + i, slots_ + i);
+                result.skip_empty();
+                return result;
+            }
+
+            size_type erase(const string_id &id) FOONATHAN_NOEXCEPT
+            {
+                return erase_index(find_index(id.hash_code(), match_id{id}));
+            }
+
+            size_type erase(hash_type hash) FOONATHAN_NOEXCEPT
+            {
+                return erase_index(find_index(hash, match_hash{hash}));
+            }
+
+            // keeps the slots
+            void clear() FOONATHAN_NOEXCEPT
+            {
+                destroy_values();
+                if (capacity_ != 0u)
+                    std::memset(ctrl_, id_ctrl_empty, capacity_);
+                size_ = 0u;
+                growth_left_ = max_items(capacity_);
+            }
+
+        protected:
+            // constructs the value from args if key isn't already stored
+            template <typename ... Args>
+            std::pair<iterator, bool> emplace_key(const string_id &key, Args&&... args)
+            {
+                auto i = find_index(key.hash_code(), match_id{key});
+                if (i != capacity_)
+                    return std::make_pair(make_iterator<iterator>(i), false);
+
+                if (growth_left_ == 0u)
+                    grow();
+                i = find_insert_pos(key.hash_code());
+                ::new(static_cast<void*>(slots_ + i)) Value(std::forward<Args>(args)...);
+                if (ctrl_[i] == id_ctrl_empty)
+                    --growth_left_;
+                ctrl_[i] = id_ctrl_hash(key.hash_code());
+                ++size_;
+                return std::make_pair(make_iterator<iterator>(i), true);
+            }
+
+        private:
+            static FOONATHAN_CONSTEXPR size_type min_capacity = 8u;
+
+            struct match_id
+            {
+                const string_id &id;
+
+                bool operator()(const string_id &key) const FOONATHAN_NOEXCEPT
+                {
+                    return key == id;
+                }
+            };
+
+            struct match_hash
+            {
+                hash_type hash;
+
+                bool operator()(const string_id &key) const FOONATHAN_NOEXCEPT
+                {
+                    return key.hash_code() == hash;
+                }
+            };
+
+            static size_type max_items(size_type capacity) FOONATHAN_NOEXCEPT
+            {
+                // maximum load factor of 3/4, deleted slots included
+                return capacity - capacity / 4;
+            }
+
+            template <class Iter>
+            Iter first() const FOONATHAN_NOEXCEPT
+            {
+                if (size_ == 0u)
+                    return Iter(ctrl_ + capacity_, slots_ + capacity_);
+                Iter result(ctrl_, slots_);
+                result.skip_empty();
+                return result;
+            }
+
+            template <class Iter>
+            Iter make_iterator(size_type i) const FOONATHAN_NOEXCEPT
+            {
+                return Iter(ctrl_ + i, slots_ + i);
+            }
+
+            // returns capacity_ if not found
+            template <class Match>
+            size_type find_index(hash_type hash, Match match) const FOONATHAN_NOEXCEPT
+            {
+                if (size_ == 0u)
+                    return capacity_;
+                auto mask = capacity_ - 1;
+                auto h2 = id_ctrl_hash(hash);
+                for (auto pos = static_cast<size_type>(hash) & mask;; pos = (pos + 1) & mask)
+                {
+                    if (ctrl_[pos] == h2 && match(get_key(slots_[pos])))
+                        return pos;
+                    else if (ctrl_[pos] == id_ctrl_empty)
+                        return capacity_;
+                }
+            }
+
+            // first empty or deleted slot
+            size_type find_insert_pos(hash_type hash) const FOONATHAN_NOEXCEPT
+            {
+                auto mask = capacity_ - 1;
+                auto pos = static_cast<size_type>(hash) & mask;
+                while (ctrl_[pos] >= 0)
+                    pos = (pos + 1) & mask;
+                return pos;
+            }
+
+            size_type erase_index(size_type i) FOONATHAN_NOEXCEPT
+            {
+                if (i == capacity_)
+                    return 0u;
+                slots_[i].~Value();
+                // if the next slot is empty, no probe sequence continues after this one
+                if (ctrl_[(i + 1) & (capacity_ - 1)] == id_ctrl_empty)
+                {
+                    ctrl_[i] = id_ctrl_empty;
+                    ++growth_left_;
+                }
+                else
+                    ctrl_[i] = id_ctrl_deleted;
+                --size_;
+                return 1u;
+            }
+
+            void destroy_values() FOONATHAN_NOEXCEPT
+            {
+                for (size_type i = 0u; i != capacity_; ++i)
+                    if (ctrl_[i] >= 0)
+                        slots_[i].~Value();
+            }
+
+            void allocate(size_type capacity)
+            {
+                std::unique_ptr<signed char[]> ctrl(new signed char[capacity + 1]);
+                slots_ = static_cast<Value*>(::operator new(capacity * sizeof(Value)));
+                ctrl_ = ctrl.release();
+                std::memset(ctrl_, id_ctrl_empty, capacity);
+                ctrl_[capacity] = id_ctrl_end;
+                capacity_ = capacity;
+                growth_left_ = max_items(capacity);
+            }
+
+            void grow()
+            {
+                // only removes deleted slots if there are enough of them
+                if (capacity_ == 0u)
+                    rehash(min_capacity);
+                else if (size_ >= max_items(capacity_) / 2)
+                    rehash(2 * capacity_);
+                else
+                    rehash(capacity_);
+            }
+
+            // strong exception safety, the values are copied if they cannot be moved without exception
+            void rehash(size_type capacity)
+            {
+                id_table table;
+                table.allocate(capacity);
+                for (size_type i = 0u; i != capacity_; ++i)
+                    if (ctrl_[i] >= 0)
+                    {
+                        auto pos = table.find_insert_pos(get_key(slots_[i]).hash_code());
+                        ::new(static_cast<void*>(table.slots_ + pos)) Value(std::move_if_noexcept(slots_[i]));
+                        table.ctrl_[pos] = ctrl_[i];
+                        ++table.size_;
+                        --table.growth_left_;
+                    }
+                swap(table);
+            }
+
+            signed char *ctrl_; // capacity_ + 1 entries, the last one is id_ctrl_end
+            Value *slots_;
+            size_type capacity_, size_, growth_left_;
+        };
+
+        template <class Value>
+        FOONATHAN_CONSTEXPR typename id_table<Value>::size_type id_table<Value>::min_capacity;
+    } // namespace detail
+    /// \endcond
+
+    /// \brief A set of \ref string_id objects.
+    /// \detail It is a hash table with open addressing that stores the ids inline,
+    /// the \ref hash_type of an id is used directly, it isn't hashed again.<br>
+    /// Besides the ids itself, it can be searched with a hashed value (e.g. \c "name"_id),
+    /// which will find an id with that hash from any database.<br>
+    /// It provides an interface similar to \c std::unordered_set:
+    /// \c begin(), \c end(), \c empty(), \c size(), \c capacity(), \c reserve(), \c find(), \c count(),
+    /// \c erase() and \c clear().
+    /// Inserting can invalidate all iterators, erasing only iterators to the erased element.
+    class string_id_set : public detail::id_table<string_id>
+    {
+    public:
+        /// \brief Creates an empty set.
+        /// \detail It does not allocate any memory.
+        string_id_set() FOONATHAN_NOEXCEPT {}
+
+        /// \brief Creates an empty set able to store the given number of ids without growing.
+        explicit string_id_set(size_type size)
+        : id_table(size) {}
+
+        /// \brief Inserts an id.
+        /// \return An iterator to the stored id and \c true if it was inserted,
+        /// \c false if it was already in the set.
+        std::pair<iterator, bool> insert(const string_id &id)
+        {
+            return emplace_key(id, id);
+        }
+    };
+
+    /// \brief A map of \ref string_id objects to \c T.
+    /// \detail It is a hash table with open addressing that stores the keys and values inline,
+    /// the \ref hash_type of an id is used directly, it isn't hashed again.<br>
+    /// Besides the ids itself, it can be searched with a hashed value (e.g. \c "name"_id),
+    /// which will find an id with that hash from any database.<br>
+    /// It provides an interface similar to \c std::unordered_map:
+    /// \c begin(), \c end(), \c empty(), \c size(), \c capacity(), \c reserve(), \c find(), \c count(),
+    /// \c erase() and \c clear().
+    /// Inserting can invalidate all iterators, erasing only iterators to the erased element.
+    template <typename T>
+    class string_id_map : public detail::id_table<std::pair<const string_id, T>>
+    {
+        typedef detail::id_table<std::pair<const string_id, T>> base;
+    public:
+        typedef T mapped_type;
+        typedef typename base::value_type value_type;
+        typedef typename base::size_type size_type;
+        typedef typename base::iterator iterator;
+        typedef typename base::const_iterator const_iterator;
+
+        /// \brief Creates an empty map.
+        /// \detail It does not allocate any memory.
+        string_id_map() FOONATHAN_NOEXCEPT {}
+
+        /// \brief Creates an empty map able to store the given number of values without growing.
+        explicit string_id_map(size_type size)
+        : base(size) {}
+
+        /// \brief Inserts a key-value-pair.
+        /// \return An iterator to the stored pair and \c true if it was inserted,
+        /// \c false if the key was already in the map.
+        std::pair<iterator, bool> insert(const value_type &value)
+        {
+            return this->emplace_key(value.first, value);
+        }
+
+        /// \brief Constructs a value from the arguments if the key isn't already in the map.
+        /// \detail Unlike \c std::unordered_map::emplace() the arguments are not used if it is,
+        /// so it behaves like \c try_emplace().
+        /// \return Same as \ref insert().
+        template <typename ... Args>
+        std::pair<iterator, bool> emplace(const string_id &key, Args&&... args)
+        {
+            return this->emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                     std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        /// \brief Returns the value belonging to a key, inserting a value-initialized one if necessary.
+        T& operator[](const string_id &key)
+        {
+            return emplace(key).first->second;
+        }
+
+        /// @{
+        /// \brief Returns the value belonging to a key or a hashed value.
+        /// \detail Throws \c std::out_of_range if it isn't in the map.
+        T& at(const string_id &key)
+        {
+            return checked(this->find(key), this->cend())->second;
+        }
+
+        const T& at(const string_id &key) const
+        {
+            return checked(this->find(key), this->cend())->second;
+        }
+
+        T& at(hash_type hash)
+        {
+            return checked(this->find(hash), this->cend())->second;
+        }
+
+        const T& at(hash_type hash) const
+        {
+            return checked(this->find(hash), this->cend())->second;
+        }
+        /// @}
+
+    private:
+        template <class Iter>
+        static Iter checked(Iter iter, const_iterator end)
+        {
+            if (iter == end)
+                throw std::out_of_range("foonathan::string_id::string_id_map: key not found");
+            return iter;
+        }
+    };
+}} // namespace foonathan::string_id
+
+#endif // FOONATHAN_STRING_ID_STRING_ID_MAP_HPP_INCLUDED
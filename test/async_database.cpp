@@ -0,0 +1,74 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "../async_database.hpp"
+#include "../database.hpp"
+#include "../error.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    sid::async_database *async = nullptr;
+    int no_collisions = 0;
+
+    // uses the database that reported the collision
+    void lookup_handler(sid::hash_type hash, const char *a, const char *b)
+    {
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(a, "second") == 0);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(b, "first") == 0);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(async->lookup(hash), "first") == 0);
+        // pending, so it has to insert the queue
+        async->insert(hash + 1u, "after", 5u);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(async->lookup(hash + 1u), "after") == 0);
+        ++no_collisions;
+    }
+}
+
+int main()
+{
+    // the handler may call back into the database
+    {
+        sid::map_database target;
+        sid::async_database db(target);
+        async = &db;
+        auto old_handler = sid::set_collision_handler(lookup_handler);
+
+        db.insert(42u, "first", 5u);
+        db.insert(42u, "second", 6u);
+        db.flush();
+        FOONATHAN_STRING_ID_CHECK(no_collisions == 1);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(db.lookup(43u), "after") == 0);
+
+        sid::set_collision_handler(old_handler);
+    }
+
+    // an exception of the handler is rethrown by flush()
+    {
+        sid::map_database target;
+        sid::async_database db(target);
+
+        db.insert(42u, "first", 5u);
+        db.insert(42u, "second", 6u);
+        // the background thread might be calling the handler concurrently,
+        // then it is rethrown by a later call
+        auto thrown = false;
+        for (auto i = 0; !thrown && i != 1000; ++i)
+            try
+            {
+                db.flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            catch (sid::collision_error &)
+            {
+                thrown = true;
+            }
+        FOONATHAN_STRING_ID_CHECK(thrown);
+    }
+}
@@ -0,0 +1,150 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+
+#include "../database.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // a hash whose probe sequence starts at slot pos of a table with the given capacity
+    // the control byte only depends on low, so they all match the same group bits
+    sid::hash_type make_hash(std::size_t pos, std::size_t k, std::size_t capacity, unsigned low = 5u)
+    {
+        return static_cast<sid::hash_type>(((pos + k * capacity) << 7) | low);
+    }
+
+    std::string make_string(std::size_t k)
+    {
+        return "string-" + std::to_string(k);
+    }
+
+    bool stored(const sid::flat_map_database &db, sid::hash_type hash, const std::string &str)
+    {
+        auto result = db.find(hash);
+        return result && result == str;
+    }
+
+    void insert(sid::flat_map_database &db, sid::hash_type hash, const std::string &str,
+                sid::basic_database::insert_status expected)
+    {
+        FOONATHAN_STRING_ID_CHECK(db.insert(hash, str.c_str(), str.size()) == expected);
+    }
+
+    // all strings start at the end of the table, so their probe sequence wraps around
+    void wrapped_probing()
+    {
+        sid::flat_map_database db(64u);
+        auto capacity = db.statistics().no_buckets;
+        auto pos = capacity - 3u;
+        // more than a group, so the probe sequence continues in the next group as well
+        auto n = capacity / 2u + 8u;
+
+        for (std::size_t k = 0u; k != n; ++k)
+            insert(db, make_hash(pos, k, capacity), make_string(k), sid::basic_database::new_string);
+        for (std::size_t k = 0u; k != n; ++k)
+            FOONATHAN_STRING_ID_CHECK(stored(db, make_hash(pos, k, capacity), make_string(k)));
+        FOONATHAN_STRING_ID_CHECK(!db.find(make_hash(pos, n, capacity)));
+        insert(db, make_hash(pos, 0u, capacity), make_string(0u), sid::basic_database::old_string);
+        insert(db, make_hash(pos, 1u, capacity), "other", sid::basic_database::collision);
+
+        // erasing must not hide the strings after it in the probe sequence
+        for (std::size_t k = 0u; k < n; k += 2u)
+            FOONATHAN_STRING_ID_CHECK(db.erase(make_hash(pos, k, capacity)));
+        FOONATHAN_STRING_ID_CHECK(!db.erase(make_hash(pos, 0u, capacity)));
+        for (std::size_t k = 0u; k != n; ++k)
+        {
+            auto hash = make_hash(pos, k, capacity);
+            if (k % 2u == 0u)
+                FOONATHAN_STRING_ID_CHECK(!db.find(hash));
+            else
+                FOONATHAN_STRING_ID_CHECK(stored(db, hash, make_string(k)));
+        }
+        FOONATHAN_STRING_ID_CHECK(db.statistics().no_strings == n / 2u);
+
+        // the slots of the erased strings are reused
+        for (std::size_t k = 0u; k < n; k += 2u)
+            insert(db, make_hash(pos, k, capacity), make_string(k), sid::basic_database::new_string);
+        for (std::size_t k = 0u; k != n; ++k)
+            FOONATHAN_STRING_ID_CHECK(stored(db, make_hash(pos, k, capacity), make_string(k)));
+        FOONATHAN_STRING_ID_CHECK(db.statistics().no_buckets == capacity);
+        FOONATHAN_STRING_ID_CHECK(db.statistics().no_rehashes == 0u);
+    }
+
+    // erasing strings in the middle of a full run leaves deleted slots, which are removed by a rehash
+    void rehash_deleted()
+    {
+        sid::flat_map_database db(256u);
+        auto capacity = db.statistics().no_buckets;
+        FOONATHAN_STRING_ID_CHECK(capacity == 256u);
+        // a run of full slots that is longer than a group
+        for (std::size_t k = 0u; k != 200u; ++k)
+            insert(db, make_hash(k, 0u, capacity), make_string(k), sid::basic_database::new_string);
+        for (std::size_t k = 0u; k != 180u; ++k)
+            FOONATHAN_STRING_ID_CHECK(db.erase(make_hash(k, 0u, capacity)));
+
+        // the deleted slots still count as used, so these insertions need a rehash
+        for (std::size_t k = 210u; k != 240u; ++k)
+            insert(db, make_hash(k, 0u, capacity), make_string(k), sid::basic_database::new_string);
+        auto stats = db.statistics();
+        FOONATHAN_STRING_ID_CHECK(stats.no_strings == 50u);
+        FOONATHAN_STRING_ID_CHECK(stats.no_rehashes == 1u);
+        // the table didn't grow, there are only a few strings
+        FOONATHAN_STRING_ID_CHECK(stats.no_buckets == capacity);
+        for (std::size_t k = 0u; k != 240u; ++k)
+        {
+            auto hash = make_hash(k, 0u, capacity);
+            if (k < 180u || (k >= 200u && k < 210u))
+                FOONATHAN_STRING_ID_CHECK(!db.find(hash));
+            else
+                FOONATHAN_STRING_ID_CHECK(stored(db, hash, make_string(k)));
+        }
+    }
+
+    // random insertions and erasures with few start positions compared with a std::map
+    void random_operations()
+    {
+        sid::flat_map_database db(16u);
+        std::map<sid::hash_type, std::string> expected;
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<std::size_t> dist(0u, 511u);
+        for (auto i = 0; i != 20000; ++i)
+        {
+            auto k = dist(engine);
+            // only 4 start positions and 2 control bytes for the initial capacity
+            auto hash = make_hash(k % 4u * 5u, k / 4u, 16u, unsigned(k % 2u));
+            auto str = make_string(k);
+            if (engine() % 3u == 0u)
+                FOONATHAN_STRING_ID_CHECK(db.erase(hash) == (expected.erase(hash) == 1u));
+            else
+            {
+                auto is_new = expected.emplace(hash, str).second;
+                insert(db, hash, str, is_new ? sid::basic_database::new_string : sid::basic_database::old_string);
+            }
+        }
+        FOONATHAN_STRING_ID_CHECK(db.statistics().no_strings == expected.size());
+        for (std::size_t k = 0u; k != 512u; ++k)
+        {
+            auto hash = make_hash(k % 4u * 5u, k / 4u, 16u, unsigned(k % 2u));
+            auto iter = expected.find(hash);
+            if (iter == expected.end())
+                FOONATHAN_STRING_ID_CHECK(!db.find(hash));
+            else
+                FOONATHAN_STRING_ID_CHECK(stored(db, hash, iter->second));
+        }
+    }
+}
+
+int main()
+{
+    wrapped_probing();
+    rehash_deleted();
+    random_operations();
+}
@@ -0,0 +1,33 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+
+#include "../database.hpp"
+#include "../frozen_database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+int main()
+{
+    sid::map_database db;
+    sid::string_id prefix("entity-", db);
+    sid::string_id(prefix, "0");
+
+    // inserting an existing string with prefix must not lock again
+    sid::map_database fallback;
+    sid::thread_safe_database<sid::frozen_database> frozen(db, &fallback);
+    sid::string_id frozen_prefix("entity-", frozen);
+    sid::basic_database::insert_status status;
+    sid::string_id id(frozen_prefix, "0", status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::old_string);
+    FOONATHAN_STRING_ID_CHECK(std::strcmp(id.string(), "entity-0") == 0);
+
+    // new strings are stored in the fallback
+    sid::string_id new_id(frozen_prefix, "1", status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::new_string);
+    FOONATHAN_STRING_ID_CHECK(std::strcmp(fallback.lookup(new_id.hash_code()), "entity-1") == 0);
+}
@@ -0,0 +1,38 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+
+#include "../generational_database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+int main()
+{
+    sid::generational_database db(16u);
+    sid::string_id global("global", db);
+
+    {
+        sid::generational_database::scope scope(db);
+        FOONATHAN_STRING_ID_CHECK(db.no_generations() == 2u);
+        sid::string_id local("local", db);
+        FOONATHAN_STRING_ID_CHECK(!db.expired(local.hash_code()));
+    }
+    FOONATHAN_STRING_ID_CHECK(db.no_generations() == 1u);
+    FOONATHAN_STRING_ID_CHECK(db.expired(sid::detail::sid_hash_n("local", 5u)));
+
+    db.begin_generation();
+    FOONATHAN_STRING_ID_CHECK(db.end_generation());
+
+    // the first generation can't be ended, the database stays usable
+    FOONATHAN_STRING_ID_CHECK(!db.end_generation());
+    FOONATHAN_STRING_ID_CHECK(!db.end_generation());
+    FOONATHAN_STRING_ID_CHECK(db.no_generations() == 1u);
+    FOONATHAN_STRING_ID_CHECK(std::strcmp(global.string(), "global") == 0);
+    sid::string_id other("other", db);
+    FOONATHAN_STRING_ID_CHECK(std::strcmp(other.string(), "other") == 0);
+    FOONATHAN_STRING_ID_CHECK(db.statistics().no_strings == 2u);
+}
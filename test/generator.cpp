@@ -0,0 +1,76 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../database.hpp"
+#include "../generator.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // the number of segments of the string and its first segment
+    std::size_t segments(const sid::map_database &db, sid::hash_type hash, std::string &first)
+    {
+        std::size_t count = 0u;
+        db.for_each_segment(hash, [&](const char *str, std::size_t length)
+                                  {
+                                      if (count++ == 0u)
+                                          first.assign(str, length);
+                                  });
+        return count;
+    }
+
+    std::vector<sid::string_id> generate(sid::basic_database &db, std::size_t n)
+    {
+        sid::string_id prefix("entity-", db);
+        sid::counter_generator generator(prefix);
+        std::vector<sid::string_id> result;
+        generator.generate(n, std::back_inserter(result));
+        FOONATHAN_STRING_ID_CHECK(result.size() == n);
+        for (std::size_t i = 0u; i != n; ++i)
+        {
+            auto expected = "entity-" + std::to_string(i);
+            FOONATHAN_STRING_ID_CHECK(result[i] == sid::string_id(expected.c_str(), db));
+            FOONATHAN_STRING_ID_CHECK(result[i].string() == expected);
+        }
+        return result;
+    }
+}
+
+int main()
+{
+    // bulk generated ids share the prefix
+    {
+        sid::map_database db(16u);
+        db.set_prefix_sharing(true);
+        auto ids = generate(db, 100u);
+        for (auto &id : ids)
+        {
+            std::string first;
+            FOONATHAN_STRING_ID_CHECK(segments(db, id.hash_code(), first) == 2u);
+            FOONATHAN_STRING_ID_CHECK(first == "entity-");
+        }
+    }
+
+    // same through the thread safe adapter
+    {
+        sid::thread_safe_database<sid::map_database> db(16u);
+        db.set_prefix_sharing(true);
+        auto ids = generate(db, 100u);
+        std::string first;
+        FOONATHAN_STRING_ID_CHECK(segments(db, ids.back().hash_code(), first) == 2u);
+    }
+
+    // databases without prefix support get the whole string
+    {
+        sid::flat_map_database db(16u);
+        generate(db, 100u);
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// built once for each hash width, independent of the configured one
+
+#include <climits>
+#include <cstring>
+
+#include "../hash.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+static_assert(sizeof(sid::hash_type) * CHAR_BIT == FOONATHAN_STRING_ID_HASH_WIDTH,
+              "hash_type doesn't have the configured width");
+
+namespace
+{
+    // the reference values of FNV-1a
+#if FOONATHAN_STRING_ID_HASH_WIDTH == 32
+    FOONATHAN_CONSTEXPR sid::hash_type hash_empty = 0x811c9dc5u;
+    FOONATHAN_CONSTEXPR sid::hash_type hash_a = 0xe40c292cu;
+    FOONATHAN_CONSTEXPR sid::hash_type hash_foobar = 0xbf9cf968u;
+#else
+    FOONATHAN_CONSTEXPR sid::hash_type hash_empty = 0xcbf29ce484222325ull;
+    FOONATHAN_CONSTEXPR sid::hash_type hash_a = 0xaf63dc4c8601ec8cull;
+    FOONATHAN_CONSTEXPR sid::hash_type hash_foobar = 0x85944171f73967e8ull;
+#endif
+
+#if FOONATHAN_STRING_ID_HAS_LITERAL
+    using namespace sid::literals;
+    static_assert(""_id == hash_empty, "literal differs from FNV-1a");
+    static_assert("a"_id == hash_a, "literal differs from FNV-1a");
+    static_assert("foobar"_id == hash_foobar, "literal differs from FNV-1a");
+#endif
+
+    sid::hash_type runtime_hash(const char *str)
+    {
+        return sid::detail::sid_hash_n(str, std::strlen(str));
+    }
+
+    void check_equal(const char *str)
+    {
+        auto hash = runtime_hash(str);
+        FOONATHAN_STRING_ID_CHECK(hash == sid::detail::sid_hash(str));
+        FOONATHAN_STRING_ID_CHECK(hash == sid::literals::id(str));
+
+        // the hash of a prefix continues with the rest
+        for (std::size_t i = 0u; i <= std::strlen(str); ++i)
+            FOONATHAN_STRING_ID_CHECK(hash == sid::detail::sid_hash_n(str + i, std::strlen(str + i),
+                                                                      sid::detail::sid_hash_n(str, i)));
+    }
+}
+
+int main()
+{
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("") == hash_empty);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("a") == hash_a);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("foobar") == hash_foobar);
+
+#if FOONATHAN_STRING_ID_HAS_LITERAL
+    // all lengths modulo the unrolling of sid_hash_n()
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("abcdefgh") == "abcdefgh"_id);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("abcdefghi") == "abcdefghi"_id);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("abcdefghij") == "abcdefghij"_id);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("abcdefghijk") == "abcdefghijk"_id);
+    FOONATHAN_STRING_ID_CHECK(runtime_hash("entity/level-01/player") == "entity/level-01/player"_id);
+#endif
+
+    const char *strings[] = {"", "a", "ab", "abc", "abcd", "abcdefgh", "abcdefghi", "abcdefghij",
+                             "abcdefghijk", "abcdefghijkl", "entity/level-01/player",
+                             "a string that is a lot longer than a single block of the hash"};
+    for (auto str : strings)
+        check_equal(str);
+}
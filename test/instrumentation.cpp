@@ -0,0 +1,57 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+// built together with the library with FOONATHAN_STRING_ID_INSTRUMENTATION enabled
+
+#include "../database.hpp"
+#include "../instrumentation.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+static_assert(FOONATHAN_STRING_ID_INSTRUMENTATION, "instrumentation must be enabled");
+
+namespace
+{
+    int no_calls = 0;
+    std::uint64_t no_acquisitions = 0u;
+    std::size_t no_strings = 0u;
+
+    // accesses the database, which must still be alive and not locked
+    void handler(const sid::basic_database &db, const sid::lock_statistics &stats)
+    {
+        ++no_calls;
+        no_acquisitions = stats.no_contended + stats.no_uncontended;
+        no_strings = db.statistics().no_strings;
+        db.find(0u);
+    }
+}
+
+int main()
+{
+    sid::set_lock_statistics_handler(handler);
+    {
+        sid::thread_safe_database<sid::map_database> db;
+        sid::string_id("foo", db);
+        sid::string_id("bar", db);
+        FOONATHAN_STRING_ID_CHECK(no_calls == 0);
+
+        // the handler acquires the lock itself, so compare with the statistics before
+        auto stats = db.instrumentation();
+        db.flush_lock_statistics();
+        FOONATHAN_STRING_ID_CHECK(no_calls == 1);
+        FOONATHAN_STRING_ID_CHECK(no_acquisitions == stats.no_contended + stats.no_uncontended);
+        FOONATHAN_STRING_ID_CHECK(no_acquisitions >= 2u);
+        FOONATHAN_STRING_ID_CHECK(no_strings == 2u);
+
+        // periodic call
+        for (std::uint64_t i = 0u; i != sid::lock_statistics_interval; ++i)
+            db.find(0u);
+        FOONATHAN_STRING_ID_CHECK(no_calls >= 2);
+        no_calls = 0;
+    }
+    // not called on destruction
+    FOONATHAN_STRING_ID_CHECK(no_calls == 0);
+}
@@ -0,0 +1,75 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <string>
+
+#include "../database.hpp"
+#include "../overlay_database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // a database that does not know about the intern cache
+    class counting_database : public sid::basic_database
+    {
+    public:
+        counting_database()
+        : no_inserts(0u) {}
+
+        insert_status insert(sid::hash_type, const char *str, std::size_t length) FOONATHAN_OVERRIDE
+        {
+            ++no_inserts;
+            last.assign(str, length);
+            return new_string;
+        }
+
+        const char* lookup(sid::hash_type) const FOONATHAN_NOEXCEPT FOONATHAN_OVERRIDE
+        {
+            return last.c_str();
+        }
+
+        std::size_t no_inserts;
+        std::string last;
+    };
+}
+
+int main()
+{
+    sid::basic_database::insert_status status;
+
+    // databases have to opt in
+    counting_database counting;
+    FOONATHAN_STRING_ID_CHECK(counting.cache_id() == 0u);
+    sid::string_id("foo", counting);
+    sid::string_id("foo", counting);
+    FOONATHAN_STRING_ID_CHECK(counting.no_inserts == 2u);
+
+    sid::dummy_database dummy;
+    sid::string_id("foo", dummy, status);
+    sid::string_id("foo", dummy, status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::new_string);
+
+    sid::map_database map;
+    FOONATHAN_STRING_ID_CHECK(map.cache_id() != 0u);
+    sid::string_id("foo", map, status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::new_string);
+    sid::string_id("foo", map, status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::old_string);
+
+    // erasing invalidates the cache
+    map.erase(sid::string_id("foo", map).hash_code());
+    sid::string_id("foo", map, status);
+    FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::new_string);
+
+    // sharded databases are cacheable if their shards are
+    sid::sharded_database<sid::map_database, 4u> sharded_map;
+    FOONATHAN_STRING_ID_CHECK(sharded_map.cache_id() != 0u);
+    sid::sharded_database<sid::dummy_database, 4u> sharded_dummy;
+    FOONATHAN_STRING_ID_CHECK(sharded_dummy.cache_id() == 0u);
+    sid::sharded_database<sid::overlay_database, 4u> sharded_overlay(map);
+    FOONATHAN_STRING_ID_CHECK(sharded_overlay.cache_id() == 0u);
+}
@@ -0,0 +1,72 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+#include <string>
+
+#include "../database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    std::string segments(const sid::map_database &db, sid::hash_type hash)
+    {
+        std::string result;
+        db.for_each_segment(hash, [&](const char *str, std::size_t length)
+                                  {
+                                      result.append(str, length);
+                                  });
+        return result;
+    }
+
+    // erases prefixes shared by other strings, the other strings must stay valid
+    void erase_shared_prefix(sid::map_database::storage_policy policy, std::size_t rehash_step)
+    {
+        sid::map_database db(4u, 1.0, policy);
+        db.set_prefix_sharing(true);
+        db.set_incremental_rehash(rehash_step);
+
+        sid::string_id prefix("scene/", db);
+        sid::string_id level(prefix, "level/");
+        // enough strings to rehash, so there might be old buckets left
+        for (auto i = 0; i != 20; ++i)
+            sid::string_id(level, std::to_string(i).c_str());
+        sid::string_id entity(level, "entity");
+        sid::string_id other(prefix, "other");
+
+        // not materialized before
+        FOONATHAN_STRING_ID_CHECK(segments(db, entity.hash_code()) == "scene/level/entity");
+
+        FOONATHAN_STRING_ID_CHECK(db.erase(level.hash_code()));
+        FOONATHAN_STRING_ID_CHECK(!db.find(level.hash_code()));
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(db.lookup(entity.hash_code()), "scene/level/entity") == 0);
+        FOONATHAN_STRING_ID_CHECK(segments(db, entity.hash_code()) == "scene/level/entity");
+        for (auto i = 0; i != 20; ++i)
+        {
+            auto expected = "scene/level/" + std::to_string(i);
+            auto hash = sid::string_id(expected.c_str(), db).hash_code();
+            FOONATHAN_STRING_ID_CHECK(db.find(hash) && db.find(hash) == expected);
+        }
+
+        FOONATHAN_STRING_ID_CHECK(db.erase(prefix.hash_code()));
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(db.lookup(other.hash_code()), "scene/other") == 0);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(db.lookup(entity.hash_code()), "scene/level/entity") == 0);
+        FOONATHAN_STRING_ID_CHECK(db.statistics().no_strings == 22u);
+
+        // the dependent strings can be erased afterwards
+        FOONATHAN_STRING_ID_CHECK(db.erase(entity.hash_code()));
+        FOONATHAN_STRING_ID_CHECK(db.erase(other.hash_code()));
+        FOONATHAN_STRING_ID_CHECK(!db.find(entity.hash_code()));
+    }
+}
+
+int main()
+{
+    erase_shared_prefix(sid::map_database::heap_storage, 0u);
+    erase_shared_prefix(sid::map_database::arena_storage, 0u);
+    erase_shared_prefix(sid::map_database::heap_storage, 1u);
+}
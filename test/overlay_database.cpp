@@ -0,0 +1,78 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstring>
+
+#include "../async_database.hpp"
+#include "../database.hpp"
+#include "../frozen_database.hpp"
+#include "../overlay_database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // the string must still be stored after the other database has erased it
+    void check_stored(sid::basic_database &db, const char *str)
+    {
+        sid::string_id id(str, db);
+        FOONATHAN_STRING_ID_CHECK(db.find(id.hash_code()) != nullptr);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(id.string(), str) == 0);
+    }
+}
+
+int main()
+{
+    // erase in the parent of an overlay
+    {
+        sid::map_database parent;
+        sid::overlay_database overlay(parent);
+
+        sid::string_id stored("player", parent);
+        check_stored(overlay, "player");
+        FOONATHAN_STRING_ID_CHECK(parent.erase(stored.hash_code()));
+        check_stored(overlay, "player");
+        FOONATHAN_STRING_ID_CHECK(overlay.local().find(stored.hash_code()) != nullptr);
+    }
+
+    // stacked overlays
+    {
+        sid::map_database global;
+        sid::overlay_database level(global);
+        sid::overlay_database request(sid::stack_on, level);
+        FOONATHAN_STRING_ID_CHECK(&request.parent() == &level);
+
+        sid::string_id("player", global);
+        sid::string_id("enemy", level);
+        sid::string_id item("item", request);
+        check_stored(request, "player");
+        check_stored(request, "enemy");
+        FOONATHAN_STRING_ID_CHECK(request.local().statistics().no_strings == 1u);
+        FOONATHAN_STRING_ID_CHECK(!level.find(item.hash_code()));
+    }
+
+    // erase in the fallback of a frozen database
+    {
+        sid::map_database source, fallback;
+        sid::string_id("player", source);
+        sid::frozen_database frozen(source, &fallback);
+
+        check_stored(frozen, "enemy");
+        FOONATHAN_STRING_ID_CHECK(fallback.erase(sid::string_id("enemy", fallback).hash_code()));
+        check_stored(frozen, "enemy");
+    }
+
+    // erase in the target of an async database
+    {
+        sid::map_database target;
+        sid::async_database async(target);
+
+        check_stored(async, "player");
+        async.flush();
+        FOONATHAN_STRING_ID_CHECK(target.erase(sid::string_id("player", target).hash_code()));
+        check_stored(async, "player");
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <climits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../database.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    typedef sid::sharded_database<sid::map_database, 16u> database;
+
+    // same as sharded_database: the highest bits select the shard
+    std::size_t shard_index(sid::hash_type hash)
+    {
+        return static_cast<std::size_t>(hash >> (sizeof(sid::hash_type) * CHAR_BIT - 4u));
+    }
+
+    sid::hash_type hash(const std::string &str)
+    {
+        return sid::detail::sid_hash_n(str.c_str(), str.size());
+    }
+
+    // the first suffix, so that prefix + suffix is in the same shard as the prefix or not
+    std::string find_suffix(const std::string &prefix, bool same_shard)
+    {
+        for (auto i = 0;; ++i)
+        {
+            auto suffix = std::to_string(i);
+            if ((shard_index(hash(prefix + suffix)) == shard_index(hash(prefix))) == same_shard)
+                return suffix;
+        }
+    }
+
+    void check_prefix(database &db, const sid::string_id &prefix, const std::string &suffix)
+    {
+        std::string full = prefix.string() + suffix;
+        sid::string_id id(prefix, suffix.c_str());
+        FOONATHAN_STRING_ID_CHECK(id == hash(full));
+        FOONATHAN_STRING_ID_CHECK(id.string() == full);
+        FOONATHAN_STRING_ID_CHECK(db.find(id.hash_code()) && db.find(id.hash_code()) == full);
+        FOONATHAN_STRING_ID_CHECK(sid::string_id(full.c_str(), db) == id);
+
+        sid::basic_database::insert_status status;
+        sid::string_id(prefix, suffix.c_str(), status);
+        FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::old_string);
+        // a different string with the same hash
+        status = db.insert_prefix(id.hash_code(), prefix.hash_code(), "x", 1u);
+        FOONATHAN_STRING_ID_CHECK(status == sid::basic_database::collision);
+    }
+}
+
+int main()
+{
+    database db;
+    sid::string_id prefix("entity-", db);
+    auto other_shard = find_suffix("entity-", false);
+    auto same_shard = find_suffix("entity-", true);
+    FOONATHAN_STRING_ID_CHECK(shard_index(hash("entity-" + other_shard)) != shard_index(prefix.hash_code()));
+    FOONATHAN_STRING_ID_CHECK(shard_index(hash("entity-" + same_shard)) == shard_index(prefix.hash_code()));
+    check_prefix(db, prefix, other_shard);
+    check_prefix(db, prefix, same_shard);
+
+    // nested prefixes from another shard
+    sid::string_id nested(prefix, other_shard.c_str());
+    auto suffix = find_suffix(nested.string(), false);
+    check_prefix(db, nested, suffix);
+    // the prefix, both strings of it and the nested one
+    FOONATHAN_STRING_ID_CHECK(db.statistics().no_strings == 4u);
+
+    // concurrent insertions of strings whose prefixes are in other shards
+    std::vector<std::thread> threads;
+    for (auto t = 0; t != 4; ++t)
+        threads.emplace_back([&, t]
+                             {
+                                 sid::string_id thread_prefix(("thread-" + std::to_string(t % 2)).c_str(), db);
+                                 for (auto i = 0; i != 1000; ++i)
+                                 {
+                                     sid::string_id(prefix, std::to_string(i).c_str());
+                                     sid::string_id(thread_prefix, std::to_string(i).c_str());
+                                 }
+                             });
+    for (auto &thread : threads)
+        thread.join();
+    for (auto i = 0; i != 1000; ++i)
+    {
+        auto str = "thread-1" + std::to_string(i);
+        FOONATHAN_STRING_ID_CHECK(db.find(hash(str)) && db.find(hash(str)) == str);
+    }
+}
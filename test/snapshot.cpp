@@ -0,0 +1,190 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../database.hpp"
+#include "../error.hpp"
+#include "../snapshot.hpp"
+#include "../string_id.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    // the layout of the file written by save_snapshot()
+    FOONATHAN_CONSTEXPR std::size_t header_size = 40u;
+    FOONATHAN_CONSTEXPR std::size_t entry_size = 16u;
+    FOONATHAN_CONSTEXPR std::size_t table_size_offset = 24u;
+    FOONATHAN_CONSTEXPR std::size_t strings_size_offset = 32u;
+    FOONATHAN_CONSTEXPR std::uint64_t empty_offset = ~std::uint64_t(0u);
+
+    std::vector<char> read_file(const char *path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const char *path, const std::vector<char> &content)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    std::uint64_t read_u64(const std::vector<char> &content, std::size_t offset)
+    {
+        std::uint64_t result;
+        std::memcpy(&result, &content[offset], sizeof(result));
+        return result;
+    }
+
+    void write_u64(std::vector<char> &content, std::size_t offset, std::uint64_t value)
+    {
+        std::memcpy(&content[offset], &value, sizeof(value));
+    }
+
+    // offset of the offset member of entry i
+    std::size_t entry_offset(std::size_t i)
+    {
+        return header_size + i * entry_size + sizeof(std::uint64_t);
+    }
+
+    bool rejected(const char *path)
+    {
+        try
+        {
+            sid::snapshot_database db(path);
+        }
+        catch (sid::snapshot_error &)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    bool rejected(const std::vector<char> &content)
+    {
+        write_file("snapshot_test_corrupt.sid", content);
+        return rejected("snapshot_test_corrupt.sid");
+    }
+
+    std::string make_string(std::size_t i)
+    {
+        return "entity-" + std::to_string(i);
+    }
+}
+
+int main()
+{
+    FOONATHAN_CONSTEXPR std::size_t no_strings = 500u;
+    std::vector<sid::hash_type> hashes;
+    {
+        sid::map_database db(64u);
+        db.set_prefix_sharing(true);
+        sid::string_id prefix("entity-", db);
+        hashes.push_back(prefix.hash_code());
+        for (std::size_t i = 1u; i != no_strings; ++i)
+            hashes.push_back(sid::string_id(prefix, std::to_string(i).c_str()).hash_code());
+        sid::save_snapshot(db, "snapshot_test.sid");
+    }
+
+    // every string can be looked up after loading
+    {
+        sid::snapshot_database db("snapshot_test.sid");
+        FOONATHAN_STRING_ID_CHECK(db.snapshot_size() == no_strings);
+        FOONATHAN_STRING_ID_CHECK(std::strcmp(db.lookup(hashes[0]), "entity-") == 0);
+        for (std::size_t i = 1u; i != no_strings; ++i)
+        {
+            FOONATHAN_STRING_ID_CHECK(db.lookup(hashes[i]) == make_string(i));
+            FOONATHAN_STRING_ID_CHECK(db.find(hashes[i]) == db.lookup(hashes[i]));
+        }
+        auto missing = make_string(no_strings);
+        FOONATHAN_STRING_ID_CHECK(!db.find(sid::detail::sid_hash_n(missing.c_str(), missing.size())));
+
+        FOONATHAN_STRING_ID_CHECK(db.insert(hashes[1], "entity-1", 8u) == sid::basic_database::old_string);
+        FOONATHAN_STRING_ID_CHECK(db.insert(hashes[1], "other", 5u) == sid::basic_database::collision);
+        sid::string_id added(missing.c_str(), db);
+        FOONATHAN_STRING_ID_CHECK(db.overlay().find(added.hash_code()));
+
+        // saved again including the new string
+        sid::save_snapshot(db, "snapshot_test_2.sid");
+        sid::snapshot_database copy("snapshot_test_2.sid");
+        FOONATHAN_STRING_ID_CHECK(copy.snapshot_size() == no_strings + 1u);
+        FOONATHAN_STRING_ID_CHECK(copy.lookup(added.hash_code()) == missing);
+        for (std::size_t i = 1u; i != no_strings; ++i)
+            FOONATHAN_STRING_ID_CHECK(copy.lookup(hashes[i]) == make_string(i));
+    }
+
+    // invalid files are rejected
+    auto content = read_file("snapshot_test.sid");
+    FOONATHAN_STRING_ID_CHECK(content.size() > header_size);
+    auto table_size = static_cast<std::size_t>(read_u64(content, table_size_offset));
+    auto strings_size = read_u64(content, strings_size_offset);
+    FOONATHAN_STRING_ID_CHECK(content.size() == header_size + table_size * entry_size + strings_size);
+
+    FOONATHAN_STRING_ID_CHECK(rejected("snapshot_test_missing.sid"));
+    FOONATHAN_STRING_ID_CHECK(rejected(std::vector<char>()));
+    FOONATHAN_STRING_ID_CHECK(rejected(std::vector<char>(content.begin(), content.begin() + header_size / 2u)));
+    FOONATHAN_STRING_ID_CHECK(rejected(std::vector<char>(content.begin(), content.end() - 1)));
+    FOONATHAN_STRING_ID_CHECK(rejected(std::vector<char>(content.begin(), content.begin() + header_size + entry_size)));
+    {
+        auto corrupt = content;
+        corrupt[0] = 'x';
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+    {
+        // the last string isn't null-terminated
+        auto corrupt = content;
+        corrupt.back() = 'x';
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+    {
+        auto corrupt = content;
+        write_u64(corrupt, table_size_offset, table_size * 2u);
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+
+    std::size_t first_empty = table_size, first_occupied = table_size;
+    for (std::size_t i = 0u; i != table_size; ++i)
+    {
+        auto offset = read_u64(content, entry_offset(i));
+        if (offset == empty_offset && first_empty == table_size)
+            first_empty = i;
+        else if (offset != empty_offset && first_occupied == table_size)
+            first_occupied = i;
+    }
+    FOONATHAN_STRING_ID_CHECK(first_empty != table_size && first_occupied != table_size);
+    {
+        // the string would start outside of the file
+        auto corrupt = content;
+        write_u64(corrupt, entry_offset(first_occupied), strings_size);
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+    {
+        // more entries than strings, lookups might not terminate with a full table
+        auto corrupt = content;
+        for (std::size_t i = 0u; i != table_size; ++i)
+            if (read_u64(corrupt, entry_offset(i)) == empty_offset)
+                write_u64(corrupt, entry_offset(i), 0u);
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+    {
+        auto corrupt = content;
+        write_u64(corrupt, entry_offset(first_empty), 0u);
+        FOONATHAN_STRING_ID_CHECK(rejected(corrupt));
+    }
+    // the unmodified file is still accepted
+    FOONATHAN_STRING_ID_CHECK(!rejected(content));
+
+    std::remove("snapshot_test.sid");
+    std::remove("snapshot_test_2.sid");
+    std::remove("snapshot_test_corrupt.sid");
+}
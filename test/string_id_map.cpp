@@ -0,0 +1,153 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../database.hpp"
+#include "../string_id_map.hpp"
+#include "test.hpp"
+
+namespace sid = foonathan::string_id;
+
+namespace
+{
+    sid::dummy_database db;
+
+    sid::string_id make_id(std::size_t k)
+    {
+        return sid::string_id(("key-" + std::to_string(k)).c_str(), db);
+    }
+
+    // n ids whose probe sequence starts at the last slot of a table with the given capacity
+    std::vector<sid::string_id> last_slot_ids(std::size_t capacity, std::size_t n)
+    {
+        std::vector<sid::string_id> result;
+        for (std::size_t k = 0u; result.size() != n; ++k)
+        {
+            auto id = make_id(k);
+            if ((id.hash_code() & (capacity - 1u)) == capacity - 1u)
+                result.push_back(id);
+        }
+        return result;
+    }
+
+    void wrapped_probing_set()
+    {
+        sid::string_id_set set(8u);
+        auto capacity = set.capacity();
+        auto ids = last_slot_ids(capacity, 6u);
+        for (auto &id : ids)
+            FOONATHAN_STRING_ID_CHECK(set.insert(id).second);
+        FOONATHAN_STRING_ID_CHECK(!set.insert(ids[3]).second);
+        FOONATHAN_STRING_ID_CHECK(set.capacity() == capacity);
+        for (auto &id : ids)
+        {
+            FOONATHAN_STRING_ID_CHECK(set.count(id) == 1u);
+            FOONATHAN_STRING_ID_CHECK(set.find(id.hash_code()) != set.end());
+        }
+
+        // erasing in the middle must not hide the ids after it
+        FOONATHAN_STRING_ID_CHECK(set.erase(ids[1]) == 1u);
+        FOONATHAN_STRING_ID_CHECK(set.erase(ids[1]) == 0u);
+        set.erase(set.find(ids[3]));
+        FOONATHAN_STRING_ID_CHECK(set.size() == 4u);
+        for (std::size_t i = 0u; i != ids.size(); ++i)
+            FOONATHAN_STRING_ID_CHECK(set.count(ids[i]) == (i == 1u || i == 3u ? 0u : 1u));
+        std::size_t no_iterated = 0u;
+        for (auto &id : set)
+        {
+            FOONATHAN_STRING_ID_CHECK(id != ids[1] && id != ids[3]);
+            ++no_iterated;
+        }
+        FOONATHAN_STRING_ID_CHECK(no_iterated == 4u);
+
+        // reinsertion after erase
+        FOONATHAN_STRING_ID_CHECK(set.insert(ids[3]).second);
+        FOONATHAN_STRING_ID_CHECK(set.insert(ids[1]).second);
+        FOONATHAN_STRING_ID_CHECK(set.erase(ids[5]) == 1u);
+        FOONATHAN_STRING_ID_CHECK(set.insert(ids[5]).second);
+        FOONATHAN_STRING_ID_CHECK(set.size() == ids.size());
+        FOONATHAN_STRING_ID_CHECK(set.capacity() == capacity);
+        for (auto &id : ids)
+            FOONATHAN_STRING_ID_CHECK(set.count(id) == 1u);
+
+        auto copy = set;
+        for (auto &id : ids)
+            FOONATHAN_STRING_ID_CHECK(copy.count(id) == 1u);
+    }
+
+    void wrapped_probing_map()
+    {
+        sid::string_id_map<int> map(8u);
+        auto ids = last_slot_ids(map.capacity(), 5u);
+        for (std::size_t i = 0u; i != ids.size(); ++i)
+            map[ids[i]] = int(i);
+        FOONATHAN_STRING_ID_CHECK(!map.emplace(ids[2], 42).second);
+        FOONATHAN_STRING_ID_CHECK(map.at(ids[2]) == 2);
+
+        FOONATHAN_STRING_ID_CHECK(map.erase(ids[0]) == 1u);
+        FOONATHAN_STRING_ID_CHECK(map.at(ids[4].hash_code()) == 4);
+        auto thrown = false;
+        try
+        {
+            map.at(ids[0]);
+        }
+        catch (std::out_of_range &)
+        {
+            thrown = true;
+        }
+        FOONATHAN_STRING_ID_CHECK(thrown);
+
+        FOONATHAN_STRING_ID_CHECK(map.emplace(ids[0], 10).second);
+        FOONATHAN_STRING_ID_CHECK(map.at(ids[0]) == 10);
+        for (std::size_t i = 1u; i != ids.size(); ++i)
+            FOONATHAN_STRING_ID_CHECK(map.at(ids[i]) == int(i));
+    }
+
+    // random insertions and erasures compared with a std::map
+    void random_operations()
+    {
+        sid::string_id_map<std::size_t> map;
+        std::map<sid::hash_type, std::size_t> expected;
+        std::mt19937 engine(42u);
+        std::uniform_int_distribution<std::size_t> dist(0u, 299u);
+        for (auto i = 0; i != 20000; ++i)
+        {
+            auto k = dist(engine);
+            auto id = make_id(k);
+            if (engine() % 3u == 0u)
+                FOONATHAN_STRING_ID_CHECK(map.erase(id) == expected.erase(id.hash_code()));
+            else
+                FOONATHAN_STRING_ID_CHECK(map.emplace(id, k).second == expected.emplace(id.hash_code(), k).second);
+        }
+        FOONATHAN_STRING_ID_CHECK(map.size() == expected.size());
+        for (std::size_t k = 0u; k != 300u; ++k)
+        {
+            auto id = make_id(k);
+            auto iter = map.find(id);
+            if (expected.count(id.hash_code()))
+                FOONATHAN_STRING_ID_CHECK(iter != map.end() && iter->second == k);
+            else
+                FOONATHAN_STRING_ID_CHECK(iter == map.end());
+        }
+        std::size_t no_iterated = 0u;
+        for (auto &value : map)
+        {
+            FOONATHAN_STRING_ID_CHECK(expected.at(value.first.hash_code()) == value.second);
+            ++no_iterated;
+        }
+        FOONATHAN_STRING_ID_CHECK(no_iterated == expected.size());
+    }
+}
+
+int main()
+{
+    wrapped_probing_set();
+    wrapped_probing_map();
+    random_operations();
+}
@@ -0,0 +1,24 @@
+// Copyright (C) 2014-2015 Jonathan Müller <jonathanmueller.dev@gmail.com>
+// This file is subject to the license terms in the LICENSE file
+// found in the top-level directory of this distribution.
+
+#ifndef FOONATHAN_STRING_ID_TEST_HPP_INCLUDED
+#define FOONATHAN_STRING_ID_TEST_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdlib>
+
+// unlike assert() it is also checked in release builds
+#define FOONATHAN_STRING_ID_CHECK(Expr) \
+    ((Expr) ? (void)0 : foonathan_string_id_test::fail(#Expr, __FILE__, __LINE__))
+
+namespace foonathan_string_id_test
+{
+    inline void fail(const char *expr, const char *file, int line)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+#endif // FOONATHAN_STRING_ID_TEST_HPP_INCLUDED